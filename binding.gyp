@@ -19,6 +19,7 @@
                         "src/keyboard.cpp",
                         "src/gamepad.cpp",
                         "src/screen.cpp",
+                        "src/injector.cpp",
                     ],
                     "include_dirs": [
                         "<!@(node -p \"require('node-addon-api').include\")",
@@ -44,6 +45,7 @@
                                 "src/keyboard.cpp",
                                 "src/gamepad.cpp",
                                 "src/screen.cpp",
+                                "src/injector.cpp",
                             ],
                             "outputs": [
                                 "tmp/main.mm",
@@ -51,10 +53,11 @@
                                 "tmp/keyboard.mm",
                                 "tmp/gamepad.mm",
                                 "tmp/screen.mm",
+                                "tmp/injector.mm",
                             ],
                             "action": [
                                 "sh", "-c",
-                                "mkdir -p tmp && cp src/main.cpp tmp/main.mm && cp src/mouse.cpp tmp/mouse.mm && cp src/keyboard.cpp tmp/keyboard.mm && cp src/gamepad.cpp tmp/gamepad.mm && cp src/screen.cpp tmp/screen.mm"
+                                "mkdir -p tmp && cp src/main.cpp tmp/main.mm && cp src/mouse.cpp tmp/mouse.mm && cp src/keyboard.cpp tmp/keyboard.mm && cp src/gamepad.cpp tmp/gamepad.mm && cp src/screen.cpp tmp/screen.mm && cp src/injector.cpp tmp/injector.mm"
                             ]
                         },
                         {
@@ -98,6 +101,7 @@
                         "tmp/keyboard.mm",
                         "tmp/gamepad.mm",
                         "tmp/screen.mm",
+                        "tmp/injector.mm",
                         "src/GamepadBridge.m",
                         "src/GamepadImplement.swift"
                     ],
@@ -159,6 +163,11 @@
                         "src/keyboard.cpp",
                         "src/gamepad.cpp",
                         "src/screen.cpp",
+                        "src/injector.cpp",
+                        "src/display.cpp",
+                        "src/uinput.cpp",
+                        "src/pixels.cpp",
+                        "src/pngencode.cpp",
                     ],
                     "include_dirs": [
                         "<!@(node -p \"require('node-addon-api').include\")",
@@ -170,6 +179,8 @@
                             "-lz",
                             "-lX11",
                             "-lXtst",
+                            "-lXext",
+                            "-lXdamage",
                             "-lXfixes",
                             "-lXrandr"
                         ]
@@ -0,0 +1,438 @@
+"use strict";
+
+import fs from "fs";
+import { spawnSync } from "child_process";
+import { fileURLToPath } from "url";
+import { Worker } from "worker_threads";
+import Control from "../dist/easy-control.cjs";
+
+
+// run fn for the given iterations and print the per call cost
+const bench = function(name, iterations, fn) {
+    // warm up
+    for (let i = 0, length = Math.min(iterations, 100); i < length; i++) {
+        fn(i);
+    }
+
+    const start = process.hrtime.bigint();
+    for (let i = 0; i < iterations; i++) {
+        fn(i);
+    }
+    const elapsed = Number(process.hrtime.bigint() - start);
+
+    const perCall = elapsed / iterations / 1000;
+    const perSecond = Math.round(iterations / (elapsed / 1e9));
+    console.log(`${name.padEnd(40)} ${perCall.toFixed(2).padStart(10)} us/op ${String(perSecond).padStart(10)} op/s`);
+    return perCall;
+};
+
+// value at the given fraction of sorted numbers
+const percentile = function(sorted, fraction) {
+    return sorted[Math.min(sorted.length - 1, Math.floor(fraction * sorted.length))];
+};
+
+// evdev nodes of the virtual gamepads, /dev/input/eventN
+const gamepadNodes = function() {
+    return fs.readdirSync("/sys/class/input").filter((name) => {
+        if (!name.startsWith("event")) {
+            return false;
+        }
+        try {
+            return fs.readFileSync(`/sys/class/input/${name}/device/name`, "utf8").trim() === "Virtual Xbox 360 Controller";
+        } catch (e) {
+            return false;
+        }
+    }).map((name) => "/dev/input/" + name);
+};
+
+// Reads the evdev node on its own thread, state[0] counts the ABS_X events, state[1] is the
+// process.hrtime of the last one and state[2] counts the SYN_DROPPED overruns
+// Assumes the 24 byte input_event of 64 bit systems
+const readerSource = `
+const { workerData } = require("worker_threads");
+const fs = require("fs");
+const state = new BigInt64Array(workerData.shared);
+const fd = fs.openSync(workerData.path, "r");
+const buffer = Buffer.alloc(24 * 64);
+try {
+    for (;;) {
+        const size = fs.readSync(fd, buffer, 0, buffer.length, null);
+        const now = process.hrtime.bigint();
+        for (let offset = 0; offset + 24 <= size; offset += 24) {
+            const type = buffer.readUInt16LE(offset + 16);
+            const code = buffer.readUInt16LE(offset + 18);
+            if (type === 3 && code === 0) {
+                Atomics.store(state, 1, now);
+                Atomics.add(state, 0, 1n);
+                Atomics.notify(state, 0);
+            } else if (type === 0 && code === 3) {
+                Atomics.add(state, 2, 1n);
+            }
+        }
+    }
+} catch (e) {
+    // the device went away
+}
+`;
+
+const benchmarks = {
+    // per keystroke latency, each keyDown/keyUp pair is one keystroke
+    "keyboard": () => {
+        bench("Keyboard.keyDown + keyUp (ShiftLeft)", 5000, () => {
+            Control.Keyboard.keyDown("ShiftLeft");
+            Control.Keyboard.keyUp("ShiftLeft");
+        });
+        bench("Keyboard.GetLayout", 1000, () => {
+            Control.Keyboard.GetLayout();
+        });
+    },
+
+    // characters per second of type(), focus a text field that can take the input
+    "type": () => {
+        const texts = {
+            "layout": "The quick brown fox jumps over the lazy dog. ".repeat(20),
+            "remapped": "→ ✓ ∑ ≠ ".repeat(100),
+        };
+        for (const [name, text] of Object.entries(texts)) {
+            const length = [...text].length;
+            const perCall = bench(`Keyboard.type ${name} (${length} chars)`, 5, () => {
+                Control.Keyboard.type(text);
+            });
+            console.log(`${"".padEnd(40)} ${String(Math.round(length / (perCall / 1e6))).padStart(10)} chars/s`);
+        }
+    },
+
+    // JS thread cost of input calls with and without the injection thread
+    "async": async () => {
+        const iterations = 5000;
+        const keystroke = () => {
+            Control.Keyboard.keyDown("ShiftLeft");
+            Control.Keyboard.keyUp("ShiftLeft");
+        };
+        bench("sync keystroke", iterations, keystroke);
+
+        Control.setAsync(true);
+        bench("async keystroke (enqueue)", iterations, keystroke);
+        const start = process.hrtime.bigint();
+        await Control.flush();
+        console.log(`${"async flush() wait".padEnd(40)} ${(Number(process.hrtime.bigint() - start) / 1e6).toFixed(2).padStart(10)} ms`);
+        Control.setAsync(false);
+    },
+
+    // moves per second with the old coordinate pair against the single warp
+    "mouse": () => {
+        bench("Mouse.setX + setY", 5000, (i) => {
+            Control.Mouse.setX(100 + (i & 63));
+            Control.Mouse.setY(100);
+        });
+        bench("Mouse.setPosition", 5000, (i) => {
+            Control.Mouse.setPosition(100 + (i & 63), 100);
+        });
+        bench("Mouse.moveBy", 5000, (i) => {
+            Control.Mouse.moveBy((i & 1) ? 1 : -1, 0);
+        });
+    },
+
+    // cursor polling cost, the cursor is unchanged between calls
+    "icon": () => {
+        bench("Mouse.getIcon", 2000, () => {
+            Control.Mouse.getIcon();
+        });
+    },
+
+    // one call per event against a single sendBatch() call
+    "batch": () => {
+        const events = 1000;
+        bench(`Mouse.setX/setY x${events}`, 20, () => {
+            for (let i = 0; i < events; i++) {
+                Control.Mouse.setX(100 + (i & 63));
+                Control.Mouse.setY(100);
+            }
+        });
+
+        const batch = new Int32Array(events * 3);
+        for (let i = 0; i < events; i++) {
+            batch[i * 3] = 1;
+            batch[i * 3 + 1] = 100 + (i & 63);
+            batch[i * 3 + 2] = 100;
+        }
+        bench(`sendBatch move x${events}`, 20, () => {
+            Control.sendBatch(batch);
+        });
+    },
+
+    // one gamepad frame with both sticks, both triggers and two buttons
+    "gamepad": async () => {
+        const gamepad = await Control.Gamepad.create();
+        const axes = new Float32Array(6);
+        bench("Gamepad.setAxis x6 + buttonDown x2", 2000, (i) => {
+            const value = (i & 1) ? 0.5 : -0.5;
+            for (let axis = 0; axis < 6; axis++) {
+                gamepad.setAxis(axis, value);
+            }
+            gamepad.buttonDown(0);
+            gamepad.buttonDown(1);
+        });
+        bench("Gamepad.setState", 2000, (i) => {
+            axes.fill((i & 1) ? 0.5 : -0.5);
+            gamepad.setState(axes, (i & 1) ? 0b11 : 0);
+        });
+        gamepad.destroy();
+    },
+
+    // JS thread cost of updating 16 gamepads per frame with calls against the shared buffers
+    "pump": async () => {
+        const pads = [];
+        for (let i = 0; i < 16; i++) {
+            pads.push(await Control.Gamepad.createAsync());
+        }
+        const axes = new Float32Array(6);
+        bench("Gamepad.setState x16", 2000, (i) => {
+            axes.fill((i & 1) ? 0.5 : -0.5);
+            for (const pad of pads) {
+                pad.setState(axes, i & 1);
+            }
+        });
+
+        const blocks = pads.map((pad) => {
+            const shared = pad.shareState();
+            return { words: new Int32Array(shared), axes: new Float32Array(shared, 8, 6) };
+        });
+        bench("shared buffer write x16", 2000, (i) => {
+            for (const block of blocks) {
+                Atomics.add(block.words, 0, 1);
+                block.axes.fill((i & 1) ? 0.5 : -0.5);
+                block.words[1] = i & 1;
+                Atomics.add(block.words, 0, 1);
+            }
+        });
+        for (const pad of pads) {
+            pad.destroy();
+        }
+    },
+
+    // update throughput against the number of gamepads, direct calls and the service pump
+    "scale": async () => {
+        const rounds = 200;
+        Control.Gamepad.setPumpRate(8000);
+        for (const count of [1, 8, 32, 64, 128]) {
+            await Control.Gamepad.configurePool({ size: count });
+            const pads = [];
+            for (let i = 0; i < count; i++) {
+                pads.push(await Control.Gamepad.createAsync());
+            }
+
+            const axes = new Float32Array(6);
+            const perRound = bench(`setState ${count} pads`, rounds, (i) => {
+                axes.fill((i & 1) ? 0.5 : -0.5);
+                for (const pad of pads) {
+                    pad.setState(axes, i & 1);
+                }
+            });
+            console.log(`${"".padEnd(40)} ${String(Math.round(count / (perRound / 1e6))).padStart(10)} pad updates/s`);
+
+            // every round waits until the service applied all blocks
+            const blocks = pads.map((pad) => {
+                const shared = pad.shareState();
+                return { words: new Int32Array(shared), axes: new Float32Array(shared, 8, 6) };
+            });
+            const start = process.hrtime.bigint();
+            for (let i = 0; i < rounds; i++) {
+                for (const block of blocks) {
+                    Atomics.add(block.words, 0, 1);
+                    block.axes.fill((i & 1) ? 0.5 : -0.5);
+                    block.words[1] = i & 1;
+                    Atomics.add(block.words, 0, 1);
+                }
+                for (const block of blocks) {
+                    while (Atomics.load(block.words, 8) !== Atomics.load(block.words, 0)) {}
+                }
+            }
+            const elapsed = Number(process.hrtime.bigint() - start) / 1e9;
+            console.log(`${`pump ${count} pads`.padEnd(40)} ${String(Math.round(rounds * count / elapsed)).padStart(10)} pad updates/s`);
+
+            for (const pad of pads) {
+                pad.destroy();
+            }
+        }
+        await Control.Gamepad.configurePool({ size: 0 });
+        Control.Gamepad.setPumpRate(500);
+    },
+
+    // Linux only, time from the input call until a reader of the evdev node sees the event,
+    // then the update rate the reader keeps up with when the calls do not wait
+    "latency": async () => {
+        const before = new Set(gamepadNodes());
+        const pad = await Control.Gamepad.createAsync();
+        const path = gamepadNodes().find((node) => !before.has(node));
+        if (path === undefined) {
+            throw new Error("Event node of the gamepad not found");
+        }
+        const shared = new SharedArrayBuffer(3 * 8);
+        const state = new BigInt64Array(shared);
+        const reader = new Worker(readerSource, { eval: true, workerData: { path, shared } });
+        const exited = new Promise((resolve) => reader.on("exit", resolve));
+        await new Promise((resolve, reject) => {
+            reader.on("online", resolve);
+            reader.on("error", reject);
+        });
+        // let the reader block in read() before the first event
+        await new Promise((resolve) => setTimeout(resolve, 100));
+
+        // wait until the reader counted target events, false on a stall
+        const waitFor = (target) => {
+            for (let count = Atomics.load(state, 0); count < target; count = Atomics.load(state, 0)) {
+                if (Atomics.wait(state, 0, count, 1000) === "timed-out") {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        // every call changes ABS_X, equal values would be filtered by evdev
+        const stateAxes = new Float32Array(1);
+        const batch = new Int32Array([5, 0, 0, 0]);
+        const paths = {
+            "setAxis": (i) => {
+                pad.setAxis(0, (i & 1) ? 0.5 : -0.5);
+            },
+            "setState": (i) => {
+                stateAxes[0] = (i & 1) ? 0.5 : -0.5;
+                pad.setState(stateAxes, 0);
+            },
+            "sendBatch": (i) => {
+                batch[3] = (i & 1) ? 16383 : -16383;
+                Control.sendBatch(batch, [pad]);
+            },
+            "setAxis async": (i) => {
+                pad.setAxis(0, (i & 1) ? 0.5 : -0.5);
+            }
+        };
+        const samples = 10000;
+        for (const [name, send] of Object.entries(paths)) {
+            Control.setAsync(name.endsWith("async"));
+
+            const latencies = new Float64Array(samples);
+            for (let i = 0; i < samples; i++) {
+                const target = Atomics.load(state, 0) + 1n;
+                const start = process.hrtime.bigint();
+                send(i);
+                if (!waitFor(target)) {
+                    throw new Error(`${name}: event ${i} never arrived`);
+                }
+                latencies[i] = Number(Atomics.load(state, 1) - start) / 1000;
+            }
+            latencies.sort();
+            console.log(`${`${name} latency`.padEnd(40)} p50 ${percentile(latencies, 0.5).toFixed(1)} us, p99 ${percentile(latencies, 0.99).toFixed(1)} us, p999 ${percentile(latencies, 0.999).toFixed(1)} us`);
+
+            // sustained rate, the reader drops events it cannot keep up with
+            const first = Atomics.load(state, 0);
+            const dropped = Atomics.load(state, 2);
+            const start = process.hrtime.bigint();
+            for (let i = 0; i < samples; i++) {
+                send(i);
+            }
+            await Control.flush();
+            waitFor(first + BigInt(samples));
+            const received = Number(Atomics.load(state, 0) - first);
+            const elapsed = Number(Atomics.load(state, 1) - start) / 1e9;
+            console.log(`${`${name} sustained`.padEnd(40)} ${String(Math.round(received / elapsed)).padStart(10)} updates/s, ${received}/${samples} received, ${Atomics.load(state, 2) - dropped} overruns`);
+        }
+        Control.setAsync(false);
+
+        // the pump adds up to one period, run it at its highest rate
+        Control.Gamepad.setPumpRate(8000);
+        const words = new Int32Array(pad.shareState());
+        const axes = new Float32Array(words.buffer, 8, 6);
+        const latencies = new Float64Array(samples / 10);
+        for (let i = 0; i < latencies.length; i++) {
+            const target = Atomics.load(state, 0) + 1n;
+            const start = process.hrtime.bigint();
+            Atomics.add(words, 0, 1);
+            axes[0] = (i & 1) ? 0.5 : -0.5;
+            Atomics.add(words, 0, 1);
+            if (!waitFor(target)) {
+                throw new Error(`shared buffer: event ${i} never arrived`);
+            }
+            latencies[i] = Number(Atomics.load(state, 1) - start) / 1000;
+        }
+        latencies.sort();
+        console.log(`${"shared buffer latency (8000 Hz)".padEnd(40)} p50 ${percentile(latencies, 0.5).toFixed(1)} us, p99 ${percentile(latencies, 0.99).toFixed(1)} us, p999 ${percentile(latencies, 0.999).toFixed(1)} us`);
+        Control.Gamepad.setPumpRate(500);
+
+        // removing the device ends the read() of the reader
+        pad.destroy();
+        await exited;
+    },
+
+    // pixel format conversion throughput of a 1920x1080 BGRX frame per kernel set, the kernels are
+    // picked once per process so every set runs in its own process
+    "convert": () => {
+        if (process.env.EASY_CONTROL_SIMD === undefined) {
+            for (const level of ["scalar", "sse2", "avx2"]) {
+                spawnSync(process.execPath, [fileURLToPath(import.meta.url), "convert"], {
+                    env: { ...process.env, EASY_CONTROL_SIMD: level },
+                    stdio: "inherit"
+                });
+            }
+            return;
+        }
+
+        const width = 1920;
+        const height = 1080;
+        const data = new ArrayBuffer(width * height * 4);
+        const pixels = new Uint32Array(data);
+        for (let i = 0; i < pixels.length; i++) {
+            pixels[i] = (i * 2654435761) >>> 0;
+        }
+        const frame = { width, height, stride: width * 4, data };
+        for (const format of ["rgba", "i420", "nv12"]) {
+            const perCall = bench(`Screen.convert ${format} (${Control.Screen.simd})`, 100, () => {
+                Control.Screen.convert(frame, format);
+            });
+            console.log(`${"".padEnd(40)} ${(data.byteLength / (perCall * 1e3)).toFixed(2).padStart(10)} GB/s`);
+        }
+    },
+
+    // encodePNG() time of a 1920x1080 frame with one stripe and with the default thread count
+    "png": async () => {
+        const width = 1920;
+        const height = 1080;
+        const data = new ArrayBuffer(width * height * 4);
+        const pixels = new Uint32Array(data);
+        for (let i = 0; i < pixels.length; i++) {
+            // flat areas and gradients like a desktop, with some noise
+            const x = i % width;
+            const y = Math.floor(i / width);
+            pixels[i] = ((x >> 6) + (y >> 6)) % 3 === 0 ? (i * 2654435761) >>> 0 : (x * 0x10101 + y) >>> 0;
+        }
+        const frame = { width, height, stride: width * 4, data };
+        for (const threads of [1, undefined]) {
+            const iterations = 10;
+            let png = await Control.Screen.encodePNG(frame, { threads });
+            const start = process.hrtime.bigint();
+            for (let i = 0; i < iterations; i++) {
+                png = await Control.Screen.encodePNG(frame, { threads });
+            }
+            const perCall = Number(process.hrtime.bigint() - start) / iterations / 1e6;
+            console.log(`${`Screen.encodePNG (${threads ?? "default"} threads)`.padEnd(40)} ${perCall.toFixed(2).padStart(10)} ms/op ${String(png.length).padStart(10)} bytes`);
+        }
+    }
+};
+
+
+// usage: node dev/bench.js [name...]
+const main = async () => {
+    let names = process.argv.slice(2);
+    if (names.length === 0) {
+        names = Object.keys(benchmarks);
+    }
+    for (const name of names) {
+        if (benchmarks[name] === undefined) {
+            throw new Error("Unknown benchmark: " + name);
+        }
+        console.log(`--- ${name} ---`);
+        await benchmarks[name]();
+    }
+};
+main();
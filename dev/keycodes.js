@@ -0,0 +1,357 @@
+"use strict";
+
+import fs from "node:fs/promises";
+import path from "node:path";
+import process from "node:process";
+import { fileURLToPath } from "node:url";
+
+
+// KeyboardEvent.code name, numeric code (Linux KEY_* value), Linux, Windows scan code, macOS virtual key
+// null marks a key the platform does not support
+const KEYS = [
+    ["Escape", 1, "KEY_ESC", "0x0001", "kVK_Escape"],
+    ["Digit1", 2, "KEY_1", "0x0002", "kVK_ANSI_1"],
+    ["Digit2", 3, "KEY_2", "0x0003", "kVK_ANSI_2"],
+    ["Digit3", 4, "KEY_3", "0x0004", "kVK_ANSI_3"],
+    ["Digit4", 5, "KEY_4", "0x0005", "kVK_ANSI_4"],
+    ["Digit5", 6, "KEY_5", "0x0006", "kVK_ANSI_5"],
+    ["Digit6", 7, "KEY_6", "0x0007", "kVK_ANSI_6"],
+    ["Digit7", 8, "KEY_7", "0x0008", "kVK_ANSI_7"],
+    ["Digit8", 9, "KEY_8", "0x0009", "kVK_ANSI_8"],
+    ["Digit9", 10, "KEY_9", "0x000A", "kVK_ANSI_9"],
+    ["Digit0", 11, "KEY_0", "0x000B", "kVK_ANSI_0"],
+    ["Minus", 12, "KEY_MINUS", "0x000C", "kVK_ANSI_Minus"],
+    ["Equal", 13, "KEY_EQUAL", "0x000D", "kVK_ANSI_Equal"],
+    ["Backspace", 14, "KEY_BACKSPACE", "0x000E", "kVK_Delete"],
+    ["Tab", 15, "KEY_TAB", "0x000F", "kVK_Tab"],
+    ["KeyQ", 16, "KEY_Q", "0x0010", "kVK_ANSI_Q"],
+    ["KeyW", 17, "KEY_W", "0x0011", "kVK_ANSI_W"],
+    ["KeyE", 18, "KEY_E", "0x0012", "kVK_ANSI_E"],
+    ["KeyR", 19, "KEY_R", "0x0013", "kVK_ANSI_R"],
+    ["KeyT", 20, "KEY_T", "0x0014", "kVK_ANSI_T"],
+    ["KeyY", 21, "KEY_Y", "0x0015", "kVK_ANSI_Y"],
+    ["KeyU", 22, "KEY_U", "0x0016", "kVK_ANSI_U"],
+    ["KeyI", 23, "KEY_I", "0x0017", "kVK_ANSI_I"],
+    ["KeyO", 24, "KEY_O", "0x0018", "kVK_ANSI_O"],
+    ["KeyP", 25, "KEY_P", "0x0019", "kVK_ANSI_P"],
+    ["BracketLeft", 26, "KEY_LEFTBRACE", "0x001A", "kVK_ANSI_LeftBracket"],
+    ["BracketRight", 27, "KEY_RIGHTBRACE", "0x001B", "kVK_ANSI_RightBracket"],
+    ["Enter", 28, "KEY_ENTER", "0x001C", "kVK_Return"],
+    ["ControlLeft", 29, "KEY_LEFTCTRL", "0x001D", "kVK_Control"],
+    ["KeyA", 30, "KEY_A", "0x001E", "kVK_ANSI_A"],
+    ["KeyS", 31, "KEY_S", "0x001F", "kVK_ANSI_S"],
+    ["KeyD", 32, "KEY_D", "0x0020", "kVK_ANSI_D"],
+    ["KeyF", 33, "KEY_F", "0x0021", "kVK_ANSI_F"],
+    ["KeyG", 34, "KEY_G", "0x0022", "kVK_ANSI_G"],
+    ["KeyH", 35, "KEY_H", "0x0023", "kVK_ANSI_H"],
+    ["KeyJ", 36, "KEY_J", "0x0024", "kVK_ANSI_J"],
+    ["KeyK", 37, "KEY_K", "0x0025", "kVK_ANSI_K"],
+    ["KeyL", 38, "KEY_L", "0x0026", "kVK_ANSI_L"],
+    ["Semicolon", 39, "KEY_SEMICOLON", "0x0027", "kVK_ANSI_Semicolon"],
+    ["Quote", 40, "KEY_APOSTROPHE", "0x0028", "kVK_ANSI_Quote"],
+    ["Backquote", 41, "KEY_GRAVE", "0x0029", "kVK_ANSI_Grave"],
+    ["ShiftLeft", 42, "KEY_LEFTSHIFT", "0x002A", "kVK_Shift"],
+    ["Backslash", 43, "KEY_BACKSLASH", "0x002B", "kVK_ANSI_Backslash"],
+    ["KeyZ", 44, "KEY_Z", "0x002C", "kVK_ANSI_Z"],
+    ["KeyX", 45, "KEY_X", "0x002D", "kVK_ANSI_X"],
+    ["KeyC", 46, "KEY_C", "0x002E", "kVK_ANSI_C"],
+    ["KeyV", 47, "KEY_V", "0x002F", "kVK_ANSI_V"],
+    ["KeyB", 48, "KEY_B", "0x0030", "kVK_ANSI_B"],
+    ["KeyN", 49, "KEY_N", "0x0031", "kVK_ANSI_N"],
+    ["KeyM", 50, "KEY_M", "0x0032", "kVK_ANSI_M"],
+    ["Comma", 51, "KEY_COMMA", "0x0033", "kVK_ANSI_Comma"],
+    ["Period", 52, "KEY_DOT", "0x0034", "kVK_ANSI_Period"],
+    ["Slash", 53, "KEY_SLASH", "0x0035", "kVK_ANSI_Slash"],
+    ["ShiftRight", 54, "KEY_RIGHTSHIFT", "0x0036", "kVK_RightShift"],
+    ["NumpadMultiply", 55, "KEY_KPASTERISK", "0x0037", "kVK_ANSI_KeypadMultiply"],
+    ["AltLeft", 56, "KEY_LEFTALT", "0x0038", "kVK_Option"],
+    ["Space", 57, "KEY_SPACE", "0x0039", "kVK_Space"],
+    ["CapsLock", 58, "KEY_CAPSLOCK", "0x003A", "kVK_CapsLock"],
+    ["F1", 59, "KEY_F1", "0x003B", "kVK_F1"],
+    ["F2", 60, "KEY_F2", "0x003C", "kVK_F2"],
+    ["F3", 61, "KEY_F3", "0x003D", "kVK_F3"],
+    ["F4", 62, "KEY_F4", "0x003E", "kVK_F4"],
+    ["F5", 63, "KEY_F5", "0x003F", "kVK_F5"],
+    ["F6", 64, "KEY_F6", "0x0040", "kVK_F6"],
+    ["F7", 65, "KEY_F7", "0x0041", "kVK_F7"],
+    ["F8", 66, "KEY_F8", "0x0042", "kVK_F8"],
+    ["F9", 67, "KEY_F9", "0x0043", "kVK_F9"],
+    ["F10", 68, "KEY_F10", "0x0044", "kVK_F10"],
+    ["NumLock", 69, "KEY_NUMLOCK", "0xE045", "kVK_ANSI_KeypadClear"],
+    ["ScrollLock", 70, "KEY_SCROLLLOCK", "0x0046", null],
+    ["Numpad7", 71, "KEY_KP7", "0x0047", "kVK_ANSI_Keypad7"],
+    ["Numpad8", 72, "KEY_KP8", "0x0048", "kVK_ANSI_Keypad8"],
+    ["Numpad9", 73, "KEY_KP9", "0x0049", "kVK_ANSI_Keypad9"],
+    ["NumpadSubtract", 74, "KEY_KPMINUS", "0x004A", "kVK_ANSI_KeypadMinus"],
+    ["Numpad4", 75, "KEY_KP4", "0x004B", "kVK_ANSI_Keypad4"],
+    ["Numpad5", 76, "KEY_KP5", "0x004C", "kVK_ANSI_Keypad5"],
+    ["Numpad6", 77, "KEY_KP6", "0x004D", "kVK_ANSI_Keypad6"],
+    ["NumpadAdd", 78, "KEY_KPPLUS", "0x004E", "kVK_ANSI_KeypadPlus"],
+    ["Numpad1", 79, "KEY_KP1", "0x004F", "kVK_ANSI_Keypad1"],
+    ["Numpad2", 80, "KEY_KP2", "0x0050", "kVK_ANSI_Keypad2"],
+    ["Numpad3", 81, "KEY_KP3", "0x0051", "kVK_ANSI_Keypad3"],
+    ["Numpad0", 82, "KEY_KP0", "0x0052", "kVK_ANSI_Keypad0"],
+    ["NumpadDecimal", 83, "KEY_KPDOT", "0x0053", "kVK_ANSI_KeypadDecimal"],
+    ["Lang5", 85, "KEY_ZENKAKUHANKAKU", null, null],
+    ["IntlBackslash", 86, "KEY_102ND", "0x0056", "kVK_ISO_Section"],
+    ["F11", 87, "KEY_F11", "0x0057", "kVK_F11"],
+    ["F12", 88, "KEY_F12", "0x0058", "kVK_F12"],
+    ["IntlRo", 89, "KEY_RO", "0x0073", "kVK_JIS_Underscore"],
+    ["Lang3", 90, "KEY_KATAKANA", "0x0078", null],
+    ["Lang4", 91, "KEY_HIRAGANA", "0x0077", null],
+    ["Convert", 92, "KEY_HENKAN", "0x0079", null],
+    ["KanaMode", 93, "KEY_KATAKANAHIRAGANA", "0x0070", null],
+    ["NonConvert", 94, "KEY_MUHENKAN", "0x007B", null],
+    ["NumpadEnter", 96, "KEY_KPENTER", "0xE01C", "kVK_ANSI_KeypadEnter"],
+    ["ControlRight", 97, "KEY_RIGHTCTRL", "0xE01D", "kVK_RightControl"],
+    ["NumpadDivide", 98, "KEY_KPSLASH", "0xE035", "kVK_ANSI_KeypadDivide"],
+    ["PrintScreen", 99, "KEY_SYSRQ", "0xE037", null],
+    ["AltRight", 100, "KEY_RIGHTALT", "0xE038", "kVK_RightOption"],
+    ["Home", 102, "KEY_HOME", "0xE047", "kVK_Home"],
+    ["ArrowUp", 103, "KEY_UP", "0xE048", "kVK_UpArrow"],
+    ["PageUp", 104, "KEY_PAGEUP", "0xE049", "kVK_PageUp"],
+    ["ArrowLeft", 105, "KEY_LEFT", "0xE04B", "kVK_LeftArrow"],
+    ["ArrowRight", 106, "KEY_RIGHT", "0xE04D", "kVK_RightArrow"],
+    ["End", 107, "KEY_END", "0xE04F", "kVK_End"],
+    ["ArrowDown", 108, "KEY_DOWN", "0xE050", "kVK_DownArrow"],
+    ["PageDown", 109, "KEY_PAGEDOWN", "0xE051", "kVK_PageDown"],
+    ["Insert", 110, "KEY_INSERT", "0xE052", "kVK_Help"],
+    ["Delete", 111, "KEY_DELETE", "0xE053", "kVK_ForwardDelete"],
+    ["VolumeMute", 113, "KEY_MUTE", null, "kVK_Mute"],
+    ["AudioVolumeMute", 113, "KEY_MUTE", "0xE020", "kVK_Mute"],
+    ["VolumeDown", 114, "KEY_VOLUMEDOWN", "0xE02E", "kVK_VolumeDown"],
+    ["AudioVolumeDown", 114, "KEY_VOLUMEDOWN", "0xE02E", "kVK_VolumeDown"],
+    ["VolumeUp", 115, "KEY_VOLUMEUP", "0xE030", "kVK_VolumeUp"],
+    ["AudioVolumeUp", 115, "KEY_VOLUMEUP", "0xE030", "kVK_VolumeUp"],
+    ["Power", 116, "KEY_POWER", "0xE05E", null],
+    ["NumpadEqual", 117, "KEY_KPEQUAL", "0x0059", "kVK_ANSI_KeypadEquals"],
+    ["Pause", 119, "KEY_PAUSE", "0x0045", null],
+    ["NumpadComma", 121, "KEY_KPCOMMA", "0x007E", "kVK_JIS_KeypadComma"],
+    ["Lang1", 122, "KEY_HANGEUL", "0x0072", "kVK_JIS_Kana"],
+    ["Lang2", 123, "KEY_HANJA", "0x0071", "kVK_JIS_Eisu"],
+    ["IntlYen", 124, "KEY_YEN", "0x007D", "kVK_JIS_Yen"],
+    ["MetaLeft", 125, "KEY_LEFTMETA", "0xE05B", "kVK_Command"],
+    ["OSLeft", 125, "KEY_LEFTMETA", "0xE05B", "kVK_Command"],
+    ["MetaRight", 126, "KEY_RIGHTMETA", "0xE05C", "0x36"],
+    ["OSRight", 126, "KEY_RIGHTMETA", "0xE05C", "0x36"],
+    ["ContextMenu", 127, "KEY_COMPOSE", "0xE05D", "0x6E"],
+    ["BrowserStop", 128, "KEY_STOP", "0xE068", null],
+    ["Abort", 128, "KEY_STOP", null, null],
+    ["Again", 129, "KEY_AGAIN", null, null],
+    ["Props", 130, "KEY_PROPS", null, null],
+    ["Undo", 131, "KEY_UNDO", "0xE008", null],
+    ["Select", 132, "KEY_FRONT", null, null],
+    ["Copy", 133, "KEY_COPY", "0xE018", null],
+    ["Open", 134, "KEY_OPEN", null, null],
+    ["Paste", 135, "KEY_PASTE", "0xE00A", null],
+    ["Find", 136, "KEY_FIND", null, null],
+    ["Cut", 137, "KEY_CUT", "0xE017", null],
+    ["Help", 138, "KEY_HELP", "0xE03B", "kVK_Help"],
+    ["LaunchApp2", 140, "KEY_CALC", "0xE021", null],
+    ["Sleep", 142, "KEY_SLEEP", "0xE05F", null],
+    ["WakeUp", 143, "KEY_WAKEUP", "0xE063", null],
+    ["LaunchApp1", 144, "KEY_FILE", "0xE06B", null],
+    ["LaunchMail", 155, "KEY_MAIL", "0xE06C", null],
+    ["BrowserFavorites", 156, "KEY_BOOKMARKS", "0xE066", null],
+    ["BrowserBack", 158, "KEY_BACK", "0xE06A", null],
+    ["BrowserForward", 159, "KEY_FORWARD", "0xE069", null],
+    ["Eject", 161, "KEY_EJECTCD", "0xE02C", null],
+    ["MediaTrackNext", 163, "KEY_NEXTSONG", "0xE019", null],
+    ["MediaPlayPause", 164, "KEY_PLAYPAUSE", "0xE022", null],
+    ["MediaTrackPrevious", 165, "KEY_PREVIOUSSONG", "0xE010", null],
+    ["MediaStop", 166, "KEY_STOPCD", "0xE024", null],
+    ["MediaSelect", 171, "KEY_CONFIG", "0xE06D", null],
+    ["BrowserHome", 172, "KEY_HOMEPAGE", "0xE032", null],
+    ["BrowserRefresh", 173, "KEY_REFRESH", "0xE067", null],
+    ["NumpadParenLeft", 179, "KEY_KPLEFTPAREN", null, null],
+    ["NumpadParenRight", 180, "KEY_KPRIGHTPAREN", null, null],
+    ["F13", 183, "KEY_F13", "0x0064", "kVK_F13"],
+    ["F14", 184, "KEY_F14", "0x0065", "kVK_F14"],
+    ["F15", 185, "KEY_F15", "0x0066", "kVK_F15"],
+    ["F16", 186, "KEY_F16", "0x0067", "kVK_F16"],
+    ["F17", 187, "KEY_F17", "0x0068", "kVK_F17"],
+    ["F18", 188, "KEY_F18", "0x0069", "kVK_F18"],
+    ["F19", 189, "KEY_F19", "0x006A", "kVK_F19"],
+    ["F20", 190, "KEY_F20", "0x006B", "kVK_F20"],
+    ["F21", 191, "KEY_F21", "0x006C", null],
+    ["F22", 192, "KEY_F22", "0x006D", null],
+    ["F23", 193, "KEY_F23", "0x006E", null],
+    ["F24", 194, "KEY_F24", "0x0076", null],
+    ["BrowserSearch", 217, "KEY_SEARCH", "0xE065", null],
+    ["Fn", 464, null, null, "kVK_Function"],];
+
+const PLATFORMS = [
+    { "define": "IS_LINUX", "column": 2 },
+    { "define": "IS_WINDOWS", "column": 3 },
+    { "define": "IS_MACOS", "column": 4 }
+];
+
+// numeric codes are below this value
+const CODE_LIMIT = 512;
+
+
+// FNV-1a, must match KeyHash() in the generated header
+const hash = function(name, seed) {
+    let h = (2166136261 ^ seed) >>> 0;
+    for (let i = 0; i < name.length; i++) {
+        h ^= name.charCodeAt(i);
+        h = Math.imul(h, 16777619) >>> 0;
+    }
+    return h;
+};
+
+// hash and displace: every bucket of the first hash gets a seed that puts its names into free slots,
+// single name buckets point straight to a slot with a negative value
+const buildPerfectHash = function(names) {
+    let size = 1;
+    while (size < names.length) {
+        size *= 2;
+    }
+
+    const buckets = [];
+    for (let i = 0; i < size; i++) {
+        buckets.push([]);
+    }
+    for (let i = 0; i < names.length; i++) {
+        buckets[hash(names[i], 0) & (size - 1)].push(i);
+    }
+    const order = [...buckets.keys()].sort((a, b) => buckets[b].length - buckets[a].length);
+
+    const displace = new Array(size).fill(0);
+    const slots = new Array(size).fill(-1);
+    let i = 0;
+    for (; i < order.length && buckets[order[i]].length > 1; i++) {
+        const bucket = buckets[order[i]];
+        for (let seed = 1; ; seed++) {
+            const used = bucket.map((index) => hash(names[index], seed) & (size - 1));
+            if (new Set(used).size === used.length && used.every((slot) => slots[slot] === -1)) {
+                used.forEach((slot, j) => {
+                    slots[slot] = bucket[j];
+                });
+                displace[order[i]] = seed;
+                break;
+            }
+        }
+    }
+
+    const free = [...slots.keys()].filter((slot) => slots[slot] === -1);
+    for (; i < order.length && buckets[order[i]].length === 1; i++) {
+        const slot = free.pop();
+        slots[slot] = buckets[order[i]][0];
+        displace[order[i]] = -slot - 1;
+    }
+    return { size, displace, slots };
+};
+
+// C array body, count values per line
+const formatArray = function(values, count) {
+    const lines = [];
+    for (let i = 0; i < values.length; i += count) {
+        lines.push("        " + values.slice(i, i + count).join(", "));
+    }
+    return lines.join(",\n");
+};
+
+const generatePlatform = function(platform) {
+    const keys = KEYS.filter((key) => key[platform.column] !== null);
+    const names = keys.map((key) => key[0]);
+    const { size, displace, slots } = buildPerfectHash(names);
+
+    const native = new Array(CODE_LIMIT).fill("-1");
+    for (const key of keys) {
+        if (native[key[1]] === "-1") {
+            native[key[1]] = key[platform.column];
+        }
+    }
+
+    return `#${platform.define === "IS_LINUX" ? "if" : "elif"} defined(${platform.define})
+    constexpr uint32_t KEY_HASH_SIZE = ${size};
+
+    constexpr KeyName KEY_NAMES[] = {
+${keys.map((key) => `        {"${key[0]}", ${key[0].length}, ${key[1]}}`).join(",\n")}
+    };
+
+    constexpr int16_t KEY_DISPLACE[KEY_HASH_SIZE] = {
+${formatArray(displace, 16)}
+    };
+
+    constexpr int16_t KEY_SLOTS[KEY_HASH_SIZE] = {
+${formatArray(slots, 16)}
+    };
+
+    constexpr int32_t KEY_NATIVE[KEY_CODE_LIMIT] = {
+${formatArray(native, 8)}
+    };
+`;
+};
+
+export const generate = function() {
+    return `// Generated by dev/keycodes.js, do not edit
+#pragma once
+#ifndef KEYCODES_H
+#define KEYCODES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(IS_LINUX)
+    #include <linux/input-event-codes.h>
+#elif defined(IS_MACOS)
+    #include <Carbon/Carbon.h>
+#endif
+
+// KeyboardEvent.code name and its numeric code, the numeric code is the Linux KEY_* value
+struct KeyName {
+    const char* name;
+    uint8_t length;
+    uint16_t code;
+};
+
+constexpr int KEY_CODE_LIMIT = ${CODE_LIMIT};
+
+${PLATFORMS.map(generatePlatform).join("\n")}#endif
+
+constexpr uint32_t KeyHash(const char* name, size_t length, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Numeric code of the name, -1 if the platform has no such key
+constexpr int KeyCodeFromName(const char* name, size_t length) {
+    int32_t displace = KEY_DISPLACE[KeyHash(name, length, 0) & (KEY_HASH_SIZE - 1)];
+    uint32_t slot = displace < 0 ? (uint32_t)(-displace - 1) : KeyHash(name, length, displace) & (KEY_HASH_SIZE - 1);
+    int16_t index = KEY_SLOTS[slot];
+    if (index < 0 || KEY_NAMES[index].length != length) {
+        return -1;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (KEY_NAMES[index].name[i] != name[i]) {
+            return -1;
+        }
+    }
+    return KEY_NAMES[index].code;
+}
+
+// Native code of the numeric code (Linux KEY_*, Windows scan code, macOS virtual key), -1 if unsupported
+constexpr int32_t KeyNativeFromCode(int code) {
+    return code >= 0 && code < KEY_CODE_LIMIT ? KEY_NATIVE[code] : -1;
+}
+
+static_assert(KeyCodeFromName("Escape", 6) == 1, "Key table is broken");
+static_assert(KeyCodeFromName("Escapf", 6) == -1, "Key table is broken");
+
+#endif
+`;
+};
+
+
+// usage: node dev/keycodes.js, writes src/keycodes.h
+if (process.argv[1] === fileURLToPath(import.meta.url)) {
+    const output = path.join(path.dirname(fileURLToPath(import.meta.url)), "../src/keycodes.h");
+    await fs.writeFile(output, generate());
+    console.log("Written: " + output);
+}
@@ -6,6 +6,8 @@ import { spawn } from "node:child_process";
 import fs from "node:fs/promises";
 import path from "node:path";
 
+import { generate as generateKeycodes } from "./dev/keycodes.js";
+
 
 // search in parameters
 const getArg = function(args, argName, isKeyValue=false, isInline=false) {
@@ -35,6 +37,9 @@ const getArg = function(args, argName, isKeyValue=false, isInline=false) {
 const build = async () => {
     // run node-gyp
     await fs.rm("./build/", { "recursive": true, "force": true });  //for safety
+
+    // generate the key code tables
+    await fs.writeFile("./src/keycodes.h", generateKeycodes());
     const ls = spawn("node-gyp", ["configure", "build"], {
         "cwd": process.cwd(),
         "shell": true,
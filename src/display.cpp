@@ -0,0 +1,67 @@
+#include "display.h"
+
+#if defined(IS_LINUX)
+    #include <mutex>
+
+    static std::mutex mainDisplayMutex;
+    static std::atomic<Display*> mainDisplay(nullptr);
+    static std::atomic<bool> mainDisplayBroken(false);
+
+    // Called by Xlib when the server connection is lost
+    // Returning keeps the process alive instead of the default exit(1)
+    static void XMainDisplayIOErrorExit(Display* display, void* userData) {
+        mainDisplayBroken.store(true);
+    }
+
+    Display* XGetMainDisplay() {
+        static std::once_flag threadsInit;
+        std::call_once(threadsInit, []() {
+            // Must run before the first connection is opened
+            XInitThreads();
+        });
+
+        std::lock_guard<std::mutex> lock(mainDisplayMutex);
+
+        // Replace a connection that hit an I/O error, Xlib skips requests on it
+        // The old Display is leaked on purpose: other threads and finalizers may still hold
+        // the pointer, and a dead connection ignores their requests instead of freed memory
+        // It also keeps the address from being reused, so pointer comparisons stay valid
+        Display* display = mainDisplay.load();
+        if (display != nullptr && mainDisplayBroken.load()) {
+            display = nullptr;
+        }
+
+        if (display == nullptr) {
+            display = XOpenDisplay(nullptr);
+            mainDisplayBroken.store(false);
+            if (display != nullptr) {
+                XSetIOErrorExitHandler(display, XMainDisplayIOErrorExit, nullptr);
+            }
+            mainDisplay.store(display);
+        }
+        return display;
+    }
+
+    Display* XPeekMainDisplay() {
+        if (mainDisplayBroken.load()) {
+            return nullptr;
+        }
+        return mainDisplay.load();
+    }
+
+    static void XThreadDisplayIOErrorExit(Display* display, void* userData) {
+        ((std::atomic<bool>*)userData)->store(true);
+    }
+
+    Display* XOpenThreadDisplay(std::atomic<bool>* broken) {
+        // XInitThreads runs on the first main display request
+        XGetMainDisplay();
+
+        broken->store(false);
+        Display* display = XOpenDisplay(nullptr);
+        if (display != nullptr) {
+            XSetIOErrorExitHandler(display, XThreadDisplayIOErrorExit, broken);
+        }
+        return display;
+    }
+#endif
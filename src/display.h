@@ -0,0 +1,24 @@
+#pragma once
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#if defined(IS_LINUX)
+    #include <X11/Xlib.h>
+    #include <atomic>
+
+    // Helper function to get the main X11 display
+    // Returns the process-wide Display* connection shared by every module,
+    // opened on first use and reopened after the server connection broke
+    Display* XGetMainDisplay();
+
+    // The current shared connection without opening or reopening one
+    // Returns nullptr when none is open or it broke, safe from finalizers and cleanup hooks
+    Display* XPeekMainDisplay();
+
+    // A private connection for a worker thread, opened after Xlib was made thread safe
+    // Losing the server sets *broken instead of exiting the process, the thread must then
+    // stop using the connection and close it
+    Display* XOpenThreadDisplay(std::atomic<bool>* broken);
+#endif
+
+#endif
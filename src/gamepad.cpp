@@ -4,6 +4,7 @@
 #include <vector>
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 
 #if defined(IS_WINDOWS)
     #include <windows.h>
@@ -24,7 +25,18 @@
     #include <unistd.h>
     #include <sys/stat.h>
     #include <fcntl.h>
+    #include <time.h>
+    #include <stddef.h>
     #include <linux/uinput.h>
+    #include <errno.h>
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <sys/timerfd.h>
+    #include <thread>
+    #include <mutex>
+    #include <atomic>
+    #include <unordered_map>
+    #include "uinput.h"
 #endif
 
 // Driver installation async implementation
@@ -49,35 +61,1217 @@ void InstallDriver::OnError(const Napi::Error& err) {
 
 
 
-std::vector<Napi::ObjectReference> gamepads;
+// Registry of the live gamepads, a slot map indexed by Gamepad::m_id
+// The id is the slot index in the low 16 bits and the slot generation above it, 0 is never used
+struct GamepadSlot {
+    Napi::ObjectReference ref;
+    uint32_t generation = 1;
+    bool isUsed = false;
+};
+static std::vector<GamepadSlot> gamepadSlots;
+static std::vector<uint32_t> gamepadFreeSlots;
+static size_t gamepadCount = 0;
+static Napi::ObjectReference gamepadListCache;
+
+#define GAMEPAD_SLOT_BITS 16
+#define GAMEPAD_SLOT_MASK ((1u << GAMEPAD_SLOT_BITS) - 1)
+
+static GamepadSlot* GamepadSlotFind(uint32_t id) {
+    uint32_t index = id & GAMEPAD_SLOT_MASK;
+    if (index >= gamepadSlots.size()) {
+        return nullptr;
+    }
+    GamepadSlot* slot = &gamepadSlots[index];
+    if (!slot->isUsed || slot->generation != (id >> GAMEPAD_SLOT_BITS)) {
+        return nullptr;
+    }
+    return slot;
+}
+
+Napi::Object Gamepad::Register(Napi::Object gamepad) {
+    uint32_t index;
+    if (!gamepadFreeSlots.empty()) {
+        index = gamepadFreeSlots.back();
+        gamepadFreeSlots.pop_back();
+    } else {
+        index = (uint32_t)gamepadSlots.size();
+        gamepadSlots.emplace_back();
+    }
+    GamepadSlot& slot = gamepadSlots[index];
+    slot.ref = Napi::Persistent(gamepad);
+    slot.isUsed = true;
+    gamepadCount++;
+    gamepadListCache.Reset();
+
+    Gamepad::Unwrap(gamepad)->m_id = (slot.generation << GAMEPAD_SLOT_BITS) | index;
+    return gamepad;
+}
+
+static void GamepadUnregister(uint32_t id) {
+    GamepadSlot* slot = GamepadSlotFind(id);
+    if (slot == nullptr) {
+        return;
+    }
+    slot->ref.Reset();  // Release the persistent reference
+    slot->isUsed = false;
+    // A new generation makes the old id invalid, skip 0 so no id is 0
+    slot->generation = (slot->generation + 1) & 0xFFFF;
+    if (slot->generation == 0) {
+        slot->generation = 1;
+    }
+    gamepadFreeSlots.push_back(id & GAMEPAD_SLOT_MASK);
+    gamepadCount--;
+    gamepadListCache.Reset();
+}
 
 Napi::Value Gamepad::list(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
-    Napi::Array gamepadsArr = Napi::Array::New(env);
-    for (size_t i = 0; i < gamepads.size(); i++) {
-        gamepadsArr.Set(i, gamepads[i].Value());
+    // Rebuilt only after create or destroy
+    if (gamepadListCache.IsEmpty()) {
+        Napi::Array gamepadsArr = Napi::Array::New(env, gamepadCount);
+        uint32_t position = 0;
+        for (size_t i = 0; i < gamepadSlots.size(); i++) {
+            if (gamepadSlots[i].isUsed) {
+                gamepadsArr.Set(position++, gamepadSlots[i].ref.Value());
+            }
+        }
+        gamepadsArr.Freeze();
+        gamepadListCache = Napi::Persistent(gamepadsArr.As<Napi::Object>());
     }
-    return gamepadsArr;
+    return gamepadListCache.Value();
 }
 
-Napi::Object Gamepad::CreateObject(const Napi::CallbackInfo& info) {
-    Napi::Object gamepad = Gamepad::NewInstance(info.Env());
-    
-    Napi::ObjectReference ref = Napi::Persistent(gamepad);
-    gamepads.push_back(std::move(ref));
+Napi::Value Gamepad::Get(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
 
-    return gamepad;
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Gamepad id expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    GamepadSlot* slot = GamepadSlotFind(info[0].As<Napi::Number>().Uint32Value());
+    if (slot == nullptr) {
+        return env.Undefined();
+    }
+    return slot->ref.Value();
+}
+
+Napi::Object Gamepad::CreateObject(const Napi::CallbackInfo& info) {
+    return Gamepad::Register(Gamepad::NewInstance(info.Env()));
 }
 
-Napi::Object Gamepad::NewInstance(Napi::Env env) {
+Napi::Object Gamepad::NewInstance(Napi::Env env, const std::initializer_list<napi_value>& args) {
     Napi::EscapableHandleScope scope(env);
-    Napi::Object obj = env.GetInstanceData<Napi::FunctionReference>()->New({});
+    Napi::Object obj = env.GetInstanceData<Napi::FunctionReference>()->New(args);
     Napi::Object ret = scope.Escape(napi_value(obj)).ToObject();
     return ret;
 }
 
+// Buttons accepted by setState, 6 and 7 press the triggers fully
+static const unsigned int GAMEPAD_BUTTON_MASK = 0x1FFFF;
+
+// Apply the deadzone and the response curve to a -1 to 1 axis value, triggers use their 0 to 1 travel
+static float GamepadAxisResponse(const GamepadResponse* response, int axis, float value) {
+    if (response == nullptr || axis < 0 || axis > 5) {
+        return value;
+    }
+    bool isTrigger = axis >= 4;
+    float x = isTrigger ? (value + 1.0f) * 0.5f : value;
+    float sign = x < 0.0f ? -1.0f : 1.0f;
+    float magnitude = x * sign;
+
+    // Scaled deadzone, the output still covers the full range
+    if (magnitude <= response->deadzone) {
+        magnitude = 0.0f;
+    } else if (response->deadzone > 0.0f) {
+        magnitude = (magnitude - response->deadzone) / (1.0f - response->deadzone);
+    }
+
+    switch (response->curves[axis]) {
+        case GAMEPAD_CURVE_QUADRATIC:
+            magnitude = magnitude * magnitude;
+            break;
+        case GAMEPAD_CURVE_LUT: {
+            const std::vector<float>& lut = response->luts[axis];
+            float position = magnitude * (float)(lut.size() - 1);
+            size_t index = (size_t)position;
+            if (index >= lut.size() - 1) {
+                magnitude = lut.back();
+            } else {
+                float fraction = position - (float)index;
+                magnitude = lut[index] + (lut[index + 1] - lut[index]) * fraction;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    x = magnitude * sign;
+    return isTrigger ? x * 2.0f - 1.0f : x;
+}
+
+// Buttons 6 and 7 press the triggers fully, releasing them gives the trigger back to the axis value
+// or releases it when no axis value was given
+static void GamepadTriggerButtons(float* axes, uint32_t& axisMask, uint32_t buttonMask, uint32_t prevMask) {
+    for (int i = 0; i < 2; i++) {
+        uint32_t bit = 1u << (6 + i);
+        int axis = 4 + i;
+        if (buttonMask & bit) {
+            axes[axis] = 1.0f;
+            axisMask |= 1u << axis;
+        } else if ((prevMask & bit) && !(axisMask & (1u << axis))) {
+            axes[axis] = -1.0f;
+            axisMask |= 1u << axis;
+        }
+    }
+}
+
+#if defined(IS_LINUX)
+// Button index to evdev key code, 0 for the triggers and the d-pad
+static const int GAMEPAD_BUTTON_CODES[17] = {
+    BTN_SOUTH, BTN_EAST, BTN_NORTH, BTN_WEST, BTN_TL, BTN_TR, 0, 0,
+    BTN_SELECT, BTN_START, BTN_THUMBL, BTN_THUMBR, 0, 0, 0, 0, BTN_MODE
+};
+
+// Upper bound of GamepadStateDiff events, 8 axes and 11 buttons
+#define GAMEPAD_MAX_EVENTS 19
+
+// Apply setState values, axes missing from axisMask keep their value
+static void GamepadStateSet(GamepadState& state, const float* axes, uint32_t axisMask, uint32_t buttonMask) {
+    for (int i = 0; i < 6; i++) {
+        if ((axisMask & (1u << i)) == 0) {
+            continue;
+        }
+        switch (i) {
+            case 0: state.thumbLX = (short)(axes[i] * 32767.0); break;
+            case 1: state.thumbLY = (short)(axes[i] * 32767.0); break;
+            case 2: state.thumbRX = (short)(axes[i] * 32767.0); break;
+            case 3: state.thumbRY = (short)(axes[i] * 32767.0); break;
+            case 4: state.leftTrigger = (unsigned char)((axes[i] + 1.0) * 127.5); break;
+            case 5: state.rightTrigger = (unsigned char)((axes[i] + 1.0) * 127.5); break;
+        }
+    }
+    state.buttons = buttonMask & GAMEPAD_BUTTON_MASK & ~0xF000u;
+    state.hatX = (signed char)(((buttonMask >> 15) & 1) - ((buttonMask >> 14) & 1));
+    state.hatY = (signed char)(((buttonMask >> 13) & 1) - ((buttonMask >> 12) & 1));
+}
+
+// Fill the events that turn prev into next, returns their count
+static size_t GamepadStateDiff(const GamepadState& prev, const GamepadState& next, struct input_event* events) {
+    const int abs[8][3] = {
+        {ABS_X, prev.thumbLX, next.thumbLX},
+        {ABS_Y, prev.thumbLY, next.thumbLY},
+        {ABS_RX, prev.thumbRX, next.thumbRX},
+        {ABS_RY, prev.thumbRY, next.thumbRY},
+        {ABS_Z, prev.leftTrigger, next.leftTrigger},
+        {ABS_RZ, prev.rightTrigger, next.rightTrigger},
+        {ABS_HAT0X, prev.hatX, next.hatX},
+        {ABS_HAT0Y, prev.hatY, next.hatY}
+    };
+    size_t count = 0;
+    memset(events, 0, GAMEPAD_MAX_EVENTS * sizeof(struct input_event));
+    for (int i = 0; i < 8; i++) {
+        if (abs[i][1] != abs[i][2]) {
+            events[count].type = EV_ABS;
+            events[count].code = abs[i][0];
+            events[count].value = abs[i][2];
+            count++;
+        }
+    }
+    unsigned int changed = prev.buttons ^ next.buttons;
+    for (int i = 0; i < 17; i++) {
+        if ((changed & (1u << i)) && GAMEPAD_BUTTON_CODES[i] != 0) {
+            events[count].type = EV_KEY;
+            events[count].code = GAMEPAD_BUTTON_CODES[i];
+            events[count].value = (next.buttons >> i) & 1;
+            count++;
+        }
+    }
+    return count;
+}
+
+// setState button mask of a device state, the d-pad goes back to bits 12 to 15
+static uint32_t GamepadStateButtons(const GamepadState& state) {
+    return state.buttons |
+        (state.hatY < 0 ? 1u << 12 : 0) | (state.hatY > 0 ? 1u << 13 : 0) |
+        (state.hatX < 0 ? 1u << 14 : 0) | (state.hatX > 0 ? 1u << 15 : 0);
+}
+
+// startRecording() log, native endian. An 8 byte header (magic, version) is followed by records of
+// a uint64 nanosecond offset from the start, a uint16 mask of the changed GamepadState fields and
+// the changed fields in field order with their GamepadState sizes. The first record holds every field.
+#define GAMEPAD_RECORDING_MAGIC 0x52504745u     // "EGPR"
+#define GAMEPAD_RECORDING_VERSION 1u
+#define GAMEPAD_RECORDING_FIELDS 9
+
+static const struct {
+    size_t offset;
+    size_t size;
+} GAMEPAD_RECORDING_LAYOUT[GAMEPAD_RECORDING_FIELDS] = {
+    {offsetof(GamepadState, thumbLX), sizeof(short)},
+    {offsetof(GamepadState, thumbLY), sizeof(short)},
+    {offsetof(GamepadState, thumbRX), sizeof(short)},
+    {offsetof(GamepadState, thumbRY), sizeof(short)},
+    {offsetof(GamepadState, leftTrigger), sizeof(unsigned char)},
+    {offsetof(GamepadState, rightTrigger), sizeof(unsigned char)},
+    {offsetof(GamepadState, buttons), sizeof(unsigned int)},
+    {offsetof(GamepadState, hatX), sizeof(signed char)},
+    {offsetof(GamepadState, hatY), sizeof(signed char)}
+};
+
+static uint64_t GamepadClock() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+// Append the fields of next that differ from prev, nothing if the states are equal
+static void GamepadRecordingAppend(std::vector<uint8_t>& log, uint64_t time, const GamepadState& prev, const GamepadState& next, bool isFull) {
+    const uint8_t* prevBytes = (const uint8_t*)&prev;
+    const uint8_t* nextBytes = (const uint8_t*)&next;
+    uint16_t mask = 0;
+    for (int i = 0; i < GAMEPAD_RECORDING_FIELDS; i++) {
+        size_t offset = GAMEPAD_RECORDING_LAYOUT[i].offset;
+        if (isFull || memcmp(prevBytes + offset, nextBytes + offset, GAMEPAD_RECORDING_LAYOUT[i].size) != 0) {
+            mask |= 1u << i;
+        }
+    }
+    if (mask == 0) {
+        return;
+    }
+    const uint8_t* timeBytes = (const uint8_t*)&time;
+    const uint8_t* maskBytes = (const uint8_t*)&mask;
+    log.insert(log.end(), timeBytes, timeBytes + sizeof(time));
+    log.insert(log.end(), maskBytes, maskBytes + sizeof(mask));
+    for (int i = 0; i < GAMEPAD_RECORDING_FIELDS; i++) {
+        if (mask & (1u << i)) {
+            const uint8_t* field = nextBytes + GAMEPAD_RECORDING_LAYOUT[i].offset;
+            log.insert(log.end(), field, field + GAMEPAD_RECORDING_LAYOUT[i].size);
+        }
+    }
+}
+
+// One replay() step, the complete state to reach at time nanoseconds after the start
+struct GamepadReplayFrame {
+    uint64_t time;
+    GamepadState state;
+};
+
+// Decode a recording into absolute states starting from state, false if the log is malformed
+static bool GamepadRecordingParse(const uint8_t* data, size_t size, GamepadState state, std::vector<GamepadReplayFrame>& frames) {
+    uint32_t header[2];
+    if (size < sizeof(header)) {
+        return false;
+    }
+    memcpy(header, data, sizeof(header));
+    if (header[0] != GAMEPAD_RECORDING_MAGIC || header[1] != GAMEPAD_RECORDING_VERSION) {
+        return false;
+    }
+    size_t position = sizeof(header);
+    uint64_t last = 0;
+    while (position < size) {
+        uint64_t time;
+        uint16_t mask;
+        if (size - position < sizeof(time) + sizeof(mask)) {
+            return false;
+        }
+        memcpy(&time, data + position, sizeof(time));
+        memcpy(&mask, data + position + sizeof(time), sizeof(mask));
+        position += sizeof(time) + sizeof(mask);
+        if (time < last || mask == 0 || mask >= (1u << GAMEPAD_RECORDING_FIELDS)) {
+            return false;
+        }
+        for (int i = 0; i < GAMEPAD_RECORDING_FIELDS; i++) {
+            if ((mask & (1u << i)) == 0) {
+                continue;
+            }
+            size_t fieldSize = GAMEPAD_RECORDING_LAYOUT[i].size;
+            if (size - position < fieldSize) {
+                return false;
+            }
+            memcpy((uint8_t*)&state + GAMEPAD_RECORDING_LAYOUT[i].offset, data + position, fieldSize);
+            position += fieldSize;
+        }
+        // Bits setState could never produce would be sent as unknown key codes
+        state.buttons &= GAMEPAD_BUTTON_MASK & ~0xF000u;
+        // The hat axes are set up as -1 to 1, like the live API clamps them
+        state.hatX = state.hatX < -1 ? -1 : (state.hatX > 1 ? 1 : state.hatX);
+        state.hatY = state.hatY < -1 ? -1 : (state.hatY > 1 ? 1 : state.hatY);
+        frames.push_back({time, state});
+        last = time;
+    }
+    return true;
+}
+
+// Force feedback effects a game can upload to one gamepad
+#define GAMEPAD_FF_EFFECTS 16
+
+// epoll tags of the service thread, device ids start from 1
+#define SERVICE_TAG_WAKE UINT64_MAX
+#define SERVICE_TAG_TIMER (UINT64_MAX - 1)
+
+// One uinput gamepad device as seen by the service thread
+struct ServiceDevice {
+    uint32_t id;
+    int fd;
+
+    // Rumble effects, the uploads are answered even without a listener
+    struct ff_effect effects[GAMEPAD_FF_EFFECTS];
+    bool hasListener = false;
+    Napi::ThreadSafeFunction tsfn;
+
+    // shareState() pump, state is owned by the service while block is set
+    GamepadState* state = nullptr;
+    const GamepadResponse* response = nullptr;
+    GamepadSharedState* block = nullptr;
+    int32_t sequence = 0;           // last applied sequence
+    uint32_t buttons = 0;           // last sampled button mask
+    float target[6] = {};           // last sampled axes after the response filters
+    float smoothed[6] = {};         // axes as sent, moving towards target
+    bool isSettling = false;        // smoothed has not reached target yet
+    size_t pumpIndex = 0;           // position in servicePumped
+
+    // startRecording() log of every state sent by the pump, the JS thread or a replay
+    bool isRecording = false;
+    uint64_t recordStart = 0;
+    GamepadState recorded = {};     // last recorded state
+    std::vector<uint8_t> recording;
+};
+
+// Payload of the 'rumble' listener call
+struct RumbleEvent {
+    double strong;
+    double weak;
+    int durationMs;
+};
+
+// Gamepad service, one epoll thread answers the force feedback requests of every device and
+// pumps the shared state blocks on a timerfd tick. Everything below is guarded by serviceMutex.
+static std::unordered_map<uint32_t, ServiceDevice*> serviceDevices;
+static std::unordered_map<int, uint32_t> serviceIds;
+static std::vector<ServiceDevice*> servicePumped;
+static uint32_t serviceNextId = 1;
+static std::mutex serviceMutex;
+static std::thread serviceThread;
+static std::atomic<bool> serviceStop{false};
+static int serviceEpollFd = -1;
+static int serviceWakeFd = -1;
+static int serviceTimerFd = -1;
+static int servicePumpRate = 500;
+
+// Run the pump while any block is shared, at servicePumpRate
+static void ServiceArmTimer() {
+    struct itimerspec spec = {};
+    if (!servicePumped.empty()) {
+        long period = 1000000000L / servicePumpRate;
+        spec.it_interval.tv_sec = period / 1000000000L;
+        spec.it_interval.tv_nsec = period % 1000000000L;
+        spec.it_value = spec.it_interval;
+    }
+    timerfd_settime(serviceTimerFd, 0, &spec, nullptr);
+}
+
+static void ServiceDeliver(ServiceDevice* device, const RumbleEvent& event) {
+    if (!device->hasListener) {
+        return;
+    }
+    RumbleEvent* data = new RumbleEvent(event);
+    auto deliver = [](Napi::Env env, Napi::Function jsCallback, RumbleEvent* data) {
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("strong", data->strong);
+        result.Set("weak", data->weak);
+        result.Set("durationMs", data->durationMs);
+        delete data;
+        jsCallback.Call({result});
+    };
+    if (device->tsfn.NonBlockingCall(data, deliver) != napi_ok) {
+        delete data;
+    }
+}
+
+// Answer the pending force feedback requests of one device
+static void ServiceRead(ServiceDevice* device) {
+    int fd = device->fd;
+    struct input_event ev;
+    while (read(fd, &ev, sizeof(ev)) == sizeof(ev)) {
+        if (ev.type == EV_UINPUT && ev.code == UI_FF_UPLOAD) {
+            struct uinput_ff_upload upload;
+            memset(&upload, 0, sizeof(upload));
+            upload.request_id = ev.value;
+            if (ioctl(fd, UI_BEGIN_FF_UPLOAD, &upload) < 0) {
+                continue;
+            }
+            if (upload.effect.type == FF_RUMBLE && upload.effect.id >= 0 && upload.effect.id < GAMEPAD_FF_EFFECTS) {
+                device->effects[upload.effect.id] = upload.effect;
+                upload.retval = 0;
+            } else {
+                upload.retval = -EINVAL;
+            }
+            ioctl(fd, UI_END_FF_UPLOAD, &upload);
+        } else if (ev.type == EV_UINPUT && ev.code == UI_FF_ERASE) {
+            struct uinput_ff_erase erase;
+            memset(&erase, 0, sizeof(erase));
+            erase.request_id = ev.value;
+            if (ioctl(fd, UI_BEGIN_FF_ERASE, &erase) < 0) {
+                continue;
+            }
+            if (erase.effect_id < GAMEPAD_FF_EFFECTS) {
+                memset(&device->effects[erase.effect_id], 0, sizeof(struct ff_effect));
+            }
+            erase.retval = 0;
+            ioctl(fd, UI_END_FF_ERASE, &erase);
+        } else if (ev.type == EV_FF && ev.code < GAMEPAD_FF_EFFECTS) {
+            // Value is the play count, 0 stops the effect
+            const struct ff_effect& effect = device->effects[ev.code];
+            RumbleEvent event = {0.0, 0.0, 0};
+            if (ev.value > 0) {
+                event.strong = effect.u.rumble.strong_magnitude / 65535.0;
+                event.weak = effect.u.rumble.weak_magnitude / 65535.0;
+                event.durationMs = effect.replay.length;
+            }
+            ServiceDeliver(device, event);
+        }
+    }
+}
+
+static void ServiceRecordLocked(ServiceDevice* device, const GamepadState& state) {
+    if (!device->isRecording) {
+        return;
+    }
+    GamepadRecordingAppend(device->recording, GamepadClock() - device->recordStart, device->recorded, state, false);
+    device->recorded = state;
+}
+
+// Send the changes of a shared block since the last applied sequence
+static void ServicePump(ServiceDevice* device) {
+    GamepadSharedState* block = device->block;
+
+    // Seqlock read, skip the block while JS is in the middle of writing it
+    int32_t sequence = __atomic_load_n(&block->sequence, __ATOMIC_ACQUIRE);
+    bool isNew = sequence != device->sequence && (sequence & 1) == 0;
+    if (isNew) {
+        uint32_t buttons = block->buttons;
+        float axes[6];
+        memcpy(axes, block->axes, sizeof(axes));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        isNew = __atomic_load_n(&block->sequence, __ATOMIC_RELAXED) == sequence;
+
+        if (isNew) {
+            // JS may write anything, clamp to the axis range and treat NaN as released
+            for (int i = 0; i < 6; i++) {
+                if (axes[i] != axes[i]) {
+                    axes[i] = i < 4 ? 0.0f : -1.0f;
+                } else if (axes[i] < -1.0f) {
+                    axes[i] = -1.0f;
+                } else if (axes[i] > 1.0f) {
+                    axes[i] = 1.0f;
+                }
+                device->target[i] = GamepadAxisResponse(device->response, i, axes[i]);
+            }
+            uint32_t axisMask = 0x3F;
+            GamepadTriggerButtons(device->target, axisMask, buttons, 0);
+            device->buttons = buttons;
+        }
+    }
+    if (!isNew && !device->isSettling) {
+        return;
+    }
+
+    // Smoothing moves towards the target on every tick until it gets there
+    float smoothing = device->response != nullptr ? device->response->smoothing : 0.0f;
+    device->isSettling = false;
+    for (int i = 0; i < 6; i++) {
+        float delta = device->target[i] - device->smoothed[i];
+        if (smoothing > 0.0f && (delta > 0.0001f || delta < -0.0001f)) {
+            device->smoothed[i] += delta * (1.0f - smoothing);
+            device->isSettling = true;
+        } else {
+            device->smoothed[i] = device->target[i];
+        }
+    }
+
+    GamepadState next = *device->state;
+    GamepadStateSet(next, device->smoothed, 0x3F, device->buttons);
+    struct input_event events[GAMEPAD_MAX_EVENTS];
+    size_t count = GamepadStateDiff(*device->state, next, events);
+    if (count > 0 && !UinputWriteFrame(device->fd, events, count)) {
+        // uinput writes are synchronous and never return EAGAIN, a failed one is tried again next tick
+        device->isSettling = true;
+        return;
+    }
+    *device->state = next;
+    ServiceRecordLocked(device, next);
+    if (isNew) {
+        device->sequence = sequence;
+        __atomic_store_n(&block->applied, sequence, __ATOMIC_RELEASE);
+    }
+}
+
+static void ServiceLoop() {
+    struct epoll_event events[64];
+    while (!serviceStop.load()) {
+        int count = epoll_wait(serviceEpollFd, events, 64, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock(serviceMutex);
+        for (int i = 0; i < count; i++) {
+            uint64_t tag = events[i].data.u64;
+            if (tag == SERVICE_TAG_WAKE) {
+                continue;
+            }
+            if (tag == SERVICE_TAG_TIMER) {
+                uint64_t expirations;
+                ssize_t size = read(serviceTimerFd, &expirations, sizeof(expirations));
+                (void)size;
+                for (ServiceDevice* device : servicePumped) {
+                    ServicePump(device);
+                }
+                continue;
+            }
+
+            // The device may be gone since epoll_wait returned, ids are never reused
+            auto it = serviceDevices.find((uint32_t)tag);
+            if (it == serviceDevices.end()) {
+                continue;
+            }
+            ServiceDevice* device = it->second;
+            if (events[i].events & EPOLLIN) {
+                ServiceRead(device);
+            }
+        }
+    }
+}
+
+// Start serving a new device, any thread, returns its id or 0 if the service is not available
+static uint32_t ServiceAdd(int fd) {
+    std::lock_guard<std::mutex> lock(serviceMutex);
+    if (serviceEpollFd < 0) {
+        serviceEpollFd = epoll_create1(EPOLL_CLOEXEC);
+        serviceWakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        serviceTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+        if (serviceEpollFd < 0 || serviceWakeFd < 0 || serviceTimerFd < 0) {
+            return 0;
+        }
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u64 = SERVICE_TAG_WAKE;
+        epoll_ctl(serviceEpollFd, EPOLL_CTL_ADD, serviceWakeFd, &event);
+        event.data.u64 = SERVICE_TAG_TIMER;
+        epoll_ctl(serviceEpollFd, EPOLL_CTL_ADD, serviceTimerFd, &event);
+        serviceStop = false;
+        serviceThread = std::thread(ServiceLoop);
+    }
+
+    // The service thread must never block in read()
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    ServiceDevice* device = new ServiceDevice();
+    device->id = serviceNextId++;
+    device->fd = fd;
+    memset(device->effects, 0, sizeof(device->effects));
+    serviceDevices[device->id] = device;
+    serviceIds[fd] = device->id;
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = device->id;
+    epoll_ctl(serviceEpollFd, EPOLL_CTL_ADD, fd, &event);
+    return device->id;
+}
+
+// Id of the device behind an open uinput fd, 0 if it is not served
+static uint32_t ServiceId(int fd) {
+    std::lock_guard<std::mutex> lock(serviceMutex);
+    auto it = serviceIds.find(fd);
+    return it == serviceIds.end() ? 0 : it->second;
+}
+
+static ServiceDevice* ServiceFind(uint32_t id) {
+    auto it = serviceDevices.find(id);
+    return it == serviceDevices.end() ? nullptr : it->second;
+}
+
+// Replace the rumble listener of a device, nullptr removes it
+static void ServiceListen(uint32_t id, const Napi::Env* env, const Napi::Function* callback) {
+    std::lock_guard<std::mutex> lock(serviceMutex);
+    ServiceDevice* device = ServiceFind(id);
+    if (device == nullptr) {
+        return;
+    }
+    if (device->hasListener) {
+        device->tsfn.Release();
+        device->hasListener = false;
+    }
+    if (callback != nullptr) {
+        device->tsfn = Napi::ThreadSafeFunction::New(*env, *callback, "GamepadRumble", 0, 1);
+        // A listener alone does not keep the process running
+        device->tsfn.Unref(*env);
+        device->hasListener = true;
+    }
+}
+
+// Let the pump drive the device from the block, false if the service is not available
+static bool ServiceShare(uint32_t id, GamepadState* state, const GamepadResponse* response, GamepadSharedState* block) {
+    std::lock_guard<std::mutex> lock(serviceMutex);
+    ServiceDevice* device = ServiceFind(id);
+    if (device == nullptr || device->block != nullptr) {
+        return false;
+    }
+    device->state = state;
+    device->response = response;
+    device->block = block;
+    device->sequence = block->sequence;
+    device->buttons = block->buttons;
+    device->isSettling = false;
+    memcpy(device->target, block->axes, sizeof(device->target));
+    memcpy(device->smoothed, block->axes, sizeof(device->smoothed));
+    device->pumpIndex = servicePumped.size();
+    servicePumped.push_back(device);
+    if (servicePumped.size() == 1) {
+        ServiceArmTimer();
+    }
+    return true;
+}
+
+static void ServiceUnshareLocked(ServiceDevice* device) {
+    if (device->block == nullptr) {
+        return;
+    }
+    // Swap with the last one, so removal stays O(1) with hundreds of devices
+    ServiceDevice* last = servicePumped.back();
+    servicePumped[device->pumpIndex] = last;
+    last->pumpIndex = device->pumpIndex;
+    servicePumped.pop_back();
+    device->state = nullptr;
+    device->block = nullptr;
+    if (servicePumped.empty()) {
+        ServiceArmTimer();
+    }
+}
+
+// Hand the state back to the JS thread, the pump does not touch it after this returns
+static void ServiceUnshare(uint32_t id) {
+    std::lock_guard<std::mutex> lock(serviceMutex);
+    ServiceDevice* device = ServiceFind(id);
+    if (device != nullptr) {
+        ServiceUnshareLocked(device);
+    }
+}
+
+// Log a state sent to the device outside of the pump, any thread
+static void ServiceRecord(uint32_t id, const GamepadState& state) {
+    std::lock_guard<std::mutex> lock(serviceMutex);
+    ServiceDevice* device = ServiceFind(id);
+    if (device != nullptr) {
+        ServiceRecordLocked(device, state);
+    }
+}
+
+// Start a new log with the current state, read under the lock as the pump may own it
+static bool ServiceRecordStart(uint32_t id, const GamepadState* state) {
+    std::lock_guard<std::mutex> lock(serviceMutex);
+    ServiceDevice* device = ServiceFind(id);
+    if (device == nullptr) {
+        return false;
+    }
+    device->isRecording = true;
+    device->recordStart = GamepadClock();
+    device->recorded = *state;
+    device->recording.clear();
+    const uint32_t header[2] = {GAMEPAD_RECORDING_MAGIC, GAMEPAD_RECORDING_VERSION};
+    device->recording.insert(device->recording.end(), (const uint8_t*)header, (const uint8_t*)header + sizeof(header));
+    GamepadRecordingAppend(device->recording, 0, *state, *state, true);
+    return true;
+}
+
+// Stop logging and move the log out, log may be nullptr to drop it
+static void ServiceRecordStop(uint32_t id, std::vector<uint8_t>* log) {
+    std::lock_guard<std::mutex> lock(serviceMutex);
+    ServiceDevice* device = ServiceFind(id);
+    if (device == nullptr) {
+        return;
+    }
+    device->isRecording = false;
+    if (log != nullptr) {
+        log->swap(device->recording);
+    }
+    std::vector<uint8_t>().swap(device->recording);
+}
+
+static void ServiceSetRate(int rate) {
+    std::lock_guard<std::mutex> lock(serviceMutex);
+    servicePumpRate = rate;
+    if (serviceTimerFd >= 0 && !servicePumped.empty()) {
+        ServiceArmTimer();
+    }
+}
+
+// Stop serving a device before it is destroyed
+static void ServiceRemove(int fd) {
+    std::lock_guard<std::mutex> lock(serviceMutex);
+    auto idIt = serviceIds.find(fd);
+    if (idIt == serviceIds.end()) {
+        return;
+    }
+    ServiceDevice* device = ServiceFind(idIt->second);
+    serviceIds.erase(idIt);
+    if (device == nullptr) {
+        return;
+    }
+    epoll_ctl(serviceEpollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ServiceUnshareLocked(device);
+    if (device->hasListener) {
+        device->tsfn.Release();
+    }
+    serviceDevices.erase(device->id);
+    delete device;
+}
+
+static void ServiceStop() {
+    if (!serviceThread.joinable()) {
+        return;
+    }
+    serviceStop = true;
+    // Wake up the epoll_wait() of the service thread
+    uint64_t one = 1;
+    ssize_t written = write(serviceWakeFd, &one, sizeof(one));
+    (void)written;
+    serviceThread.join();
+
+    std::lock_guard<std::mutex> lock(serviceMutex);
+    for (auto& entry : serviceDevices) {
+        if (entry.second->hasListener) {
+            entry.second->tsfn.Release();
+        }
+        delete entry.second;
+    }
+    serviceDevices.clear();
+    serviceIds.clear();
+    servicePumped.clear();
+    close(serviceEpollFd);
+    close(serviceWakeFd);
+    close(serviceTimerFd);
+    serviceEpollFd = -1;
+    serviceWakeFd = -1;
+    serviceTimerFd = -1;
+}
+
+// A replay() in progress, the thread writes the device until the last frame or a cancel
+struct GamepadReplay {
+    std::thread thread;
+    std::atomic<bool> isCancelled{false};
+    bool isFailed = false;
+    int fd;
+    uint32_t deviceId;
+    double speed;
+    std::vector<GamepadReplayFrame> frames;
+    GamepadState state;             // state of the device as last written by the thread
+
+    Gamepad* gamepad;
+    Napi::ObjectReference gamepadRef;   // keeps the gamepad alive until the promise settles
+    Napi::Promise::Deferred deferred;
+    Napi::ThreadSafeFunction tsfn;
+
+    GamepadReplay(Napi::Env env) : deferred(env) {}
+};
+
+// Replays still running, JS thread only
+static std::vector<GamepadReplay*> gamepadReplays;
+
+// JS thread, settle the promise of a replay that left its thread
+static void GamepadReplayDone(Napi::Env env, Napi::Function jsCallback, GamepadReplay* replay) {
+    if (replay->thread.joinable()) {
+        replay->thread.join();
+    }
+    for (size_t i = 0; i < gamepadReplays.size(); i++) {
+        if (gamepadReplays[i] == replay) {
+            gamepadReplays[i] = gamepadReplays.back();
+            gamepadReplays.pop_back();
+            break;
+        }
+    }
+
+    if (!replay->gamepad->EndReplay(replay, replay->state)) {
+        replay->deferred.Reject(Napi::Error::New(env, "Replay stopped, the gamepad was destroyed").Value());
+    } else if (replay->isFailed) {
+        replay->deferred.Reject(Napi::Error::New(env, "Failed to replay gamepad recording").Value());
+    } else {
+        replay->deferred.Resolve(env.Undefined());
+    }
+    replay->gamepadRef.Reset();
+    delete replay;
+}
+
+static void GamepadReplayRun(GamepadReplay* replay) {
+    const uint64_t slice = 10000000ull;
+    uint64_t start = GamepadClock();
+    struct input_event events[GAMEPAD_MAX_EVENTS];
+
+    for (const GamepadReplayFrame& frame : replay->frames) {
+        // Sleep to the absolute deadline, long pauses in short steps so a cancel is seen early
+        uint64_t deadline = start + (uint64_t)((double)frame.time / replay->speed);
+        while (!replay->isCancelled.load()) {
+            uint64_t now = GamepadClock();
+            if (now >= deadline) {
+                break;
+            }
+            uint64_t wake = deadline - now > slice ? now + slice : deadline;
+            struct timespec spec;
+            spec.tv_sec = (time_t)(wake / 1000000000ull);
+            spec.tv_nsec = (long)(wake % 1000000000ull);
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &spec, nullptr);
+        }
+        if (replay->isCancelled.load()) {
+            break;
+        }
+
+        size_t count = GamepadStateDiff(replay->state, frame.state, events);
+        // uinput writes are synchronous, O_NONBLOCK never makes them return EAGAIN
+        bool isWritten = count == 0 || UinputWriteFrame(replay->fd, events, count);
+        if (!isWritten) {
+            replay->isFailed = true;
+            break;
+        }
+        replay->state = frame.state;
+        ServiceRecord(replay->deviceId, frame.state);
+    }
+
+    // The callback deletes the replay, keep the handle for the release
+    Napi::ThreadSafeFunction tsfn = replay->tsfn;
+    tsfn.BlockingCall(replay, GamepadReplayDone);
+    tsfn.Release();
+}
+
+// JS thread, stop the thread writing the device, the promise settles later
+static void GamepadReplayCancel(GamepadReplay* replay) {
+    replay->isCancelled = true;
+    if (replay->thread.joinable()) {
+        replay->thread.join();
+    }
+}
+
+// Create the uinput device and wait for its event node, returns the uinput fd or -1
+// errno is ETIMEDOUT when the device was created but its event node did not show up
+// Blocks for the device setup, createAsync() runs it on the threadpool
+static int GamepadDeviceOpen() {
+    int fd = UinputOpen();
+    if (fd < 0) {
+        return -1;
+    }
+
+    // Enable event types
+    if (ioctl(fd, UI_SET_EVBIT, EV_KEY) < 0) {
+        close(fd);
+        return -1;
+    }
+    
+    if (ioctl(fd, UI_SET_EVBIT, EV_ABS) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    // Rumble, the requests are answered by the force feedback service thread
+    ioctl(fd, UI_SET_EVBIT, EV_FF);
+    ioctl(fd, UI_SET_FFBIT, FF_RUMBLE);
+
+    // Enable buttons (BTN_GAMEPAD + standard Xbox buttons)
+    ioctl(fd, UI_SET_KEYBIT, BTN_SOUTH);      // A
+    ioctl(fd, UI_SET_KEYBIT, BTN_EAST);       // B
+    ioctl(fd, UI_SET_KEYBIT, BTN_NORTH);      // X
+    ioctl(fd, UI_SET_KEYBIT, BTN_WEST);       // Y
+    ioctl(fd, UI_SET_KEYBIT, BTN_TL);         // LB
+    ioctl(fd, UI_SET_KEYBIT, BTN_TR);         // RB
+    ioctl(fd, UI_SET_KEYBIT, BTN_SELECT);     // Back
+    ioctl(fd, UI_SET_KEYBIT, BTN_START);      // Start
+    ioctl(fd, UI_SET_KEYBIT, BTN_MODE);       // Guide
+    ioctl(fd, UI_SET_KEYBIT, BTN_THUMBL);     // Left Stick
+    ioctl(fd, UI_SET_KEYBIT, BTN_THUMBR);     // Right Stick
+
+    // Enable axes
+    ioctl(fd, UI_SET_ABSBIT, ABS_X);          // Left stick X
+    ioctl(fd, UI_SET_ABSBIT, ABS_Y);          // Left stick Y
+    ioctl(fd, UI_SET_ABSBIT, ABS_RX);         // Right stick X
+    ioctl(fd, UI_SET_ABSBIT, ABS_RY);         // Right stick Y
+    ioctl(fd, UI_SET_ABSBIT, ABS_Z);          // Left trigger
+    ioctl(fd, UI_SET_ABSBIT, ABS_RZ);         // Right trigger
+    ioctl(fd, UI_SET_ABSBIT, ABS_HAT0X);      // D-pad X
+    ioctl(fd, UI_SET_ABSBIT, ABS_HAT0Y);      // D-pad Y
+
+    // Setup device
+    struct uinput_setup usetup;
+    memset(&usetup, 0, sizeof(usetup));
+    usetup.id.bustype = BUS_USB;
+    usetup.id.vendor = 0x045e;  // Microsoft
+    usetup.id.product = 0x028e; // Xbox 360 Controller
+    usetup.id.version = 1;
+    strncpy(usetup.name, "Virtual Xbox 360 Controller", UINPUT_MAX_NAME_SIZE);
+    usetup.ff_effects_max = GAMEPAD_FF_EFFECTS;
+
+    // Configure axis ranges
+    struct uinput_abs_setup abs_setup;
+    memset(&abs_setup, 0, sizeof(abs_setup));
+    
+    // Left stick X
+    abs_setup.code = ABS_X;
+    abs_setup.absinfo.minimum = -32768;
+    abs_setup.absinfo.maximum = 32767;
+    abs_setup.absinfo.value = 0;
+    ioctl(fd, UI_ABS_SETUP, &abs_setup);
+    
+    // Left stick Y
+    abs_setup.code = ABS_Y;
+    ioctl(fd, UI_ABS_SETUP, &abs_setup);
+    
+    // Right stick X
+    abs_setup.code = ABS_RX;
+    ioctl(fd, UI_ABS_SETUP, &abs_setup);
+    
+    // Right stick Y
+    abs_setup.code = ABS_RY;
+    ioctl(fd, UI_ABS_SETUP, &abs_setup);
+    
+    // Triggers (0-255)
+    abs_setup.absinfo.minimum = 0;
+    abs_setup.absinfo.maximum = 255;
+    abs_setup.code = ABS_Z;
+    ioctl(fd, UI_ABS_SETUP, &abs_setup);
+    
+    abs_setup.code = ABS_RZ;
+    ioctl(fd, UI_ABS_SETUP, &abs_setup);
+    
+    // D-pad (-1, 0, 1)
+    abs_setup.absinfo.minimum = -1;
+    abs_setup.absinfo.maximum = 1;
+    abs_setup.code = ABS_HAT0X;
+    ioctl(fd, UI_ABS_SETUP, &abs_setup);
+    
+    abs_setup.code = ABS_HAT0Y;
+    ioctl(fd, UI_ABS_SETUP, &abs_setup);
+
+    // Create the device
+    if (ioctl(fd, UI_DEV_SETUP, &usetup) < 0) {
+        close(fd);
+        return -1;
+    }
+    
+    if (ioctl(fd, UI_DEV_CREATE) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    // Uploads block the game until they are answered, serve them before the node shows up
+    ServiceAdd(fd);
+
+    // Wait for the event node instead of a fixed delay, a device without it is unusable
+    if (!UinputWaitForNode(fd, 1000)) {
+        ServiceRemove(fd);
+        ioctl(fd, UI_DEV_DESTROY);
+        close(fd);
+        errno = ETIMEDOUT;
+        return -1;
+    }
+    return fd;
+}
+#endif
+
+#if defined(IS_LINUX)
+// Message of the last failed GamepadDeviceOpen() on this thread
+static const char* GamepadDeviceError() {
+    if (errno == ETIMEDOUT) {
+        return "Gamepad device was created but its /dev/input node did not appear in time";
+    }
+    return "Failed to create gamepad device";
+}
+
+// Idle devices kept for create(), the last given back is handed out first
+static std::vector<int> gamepadPool;
+static size_t gamepadPoolSize = 0;
+static bool gamepadPoolClosed = false;
+
+static void GamepadDeviceClose(int fd) {
+    ServiceRemove(fd);
+    ioctl(fd, UI_DEV_DESTROY);
+    close(fd);
+}
+
+// Take an idle device, -1 if the pool is empty
+static int GamepadPoolTake() {
+    if (gamepadPool.empty()) {
+        return -1;
+    }
+    int fd = gamepadPool.back();
+    gamepadPool.pop_back();
+    return fd;
+}
+
+// Reset the device to neutral and keep it for the next create(), false if the pool is full
+static bool GamepadPoolGive(int fd, const GamepadState* state) {
+    if (gamepadPoolClosed || gamepadPool.size() >= gamepadPoolSize) {
+        return false;
+    }
+
+    if (state != nullptr) {
+        GamepadState neutral;
+        memset(&neutral, 0, sizeof(neutral));
+        struct input_event events[GAMEPAD_MAX_EVENTS];
+        size_t count = GamepadStateDiff(*state, neutral, events);
+        if (count > 0 && !UinputWriteFrame(fd, events, count)) {
+            return false;
+        }
+    }
+
+    gamepadPool.push_back(fd);
+    return true;
+}
+#endif
+
+// Gamepad creation async implementation
+CreateGamepad::CreateGamepad(const Napi::Env& env) : Napi::AsyncWorker{env, "CreateGamepad"}, m_deferred{env} {}
+
+CreateGamepad::~CreateGamepad() {
+    #if defined(IS_LINUX)
+        // Not adopted by a gamepad object
+        if (this->m_uinput_fd >= 0) {
+            GamepadDeviceClose(this->m_uinput_fd);
+        }
+    #endif
+}
+
+Napi::Promise CreateGamepad::GetPromise() {
+    return m_deferred.Promise();
+}
+
+void CreateGamepad::Execute() {
+    #if defined(IS_LINUX)
+        this->m_uinput_fd = GamepadDeviceOpen();
+        if (this->m_uinput_fd < 0) {
+            SetError(GamepadDeviceError());
+        }
+    #endif
+}
+
+void CreateGamepad::OnOK() {
+    Napi::Env env = Env();
+
+    // Windows and macOS create the device in the constructor on the JS thread
+    #if defined(IS_LINUX)
+        Napi::Object gamepad = Gamepad::NewInstance(env, {Napi::External<int>::New(env, &this->m_uinput_fd)});
+        this->m_uinput_fd = -1;
+    #else
+        Napi::Object gamepad = Gamepad::NewInstance(env);
+    #endif
+
+    m_deferred.Resolve(Gamepad::Register(gamepad));
+}
+
+void CreateGamepad::OnError(const Napi::Error& err) {
+    m_deferred.Reject(err.Value());
+}
+
+Napi::Promise Gamepad::CreateAsync(const Napi::CallbackInfo& info) {
+    #if defined(IS_LINUX)
+        // A pooled device is ready, no need for the threadpool
+        if (!gamepadPool.empty()) {
+            Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(info.Env());
+            deferred.Resolve(Gamepad::CreateObject(info));
+            return deferred.Promise();
+        }
+    #endif
+
+    CreateGamepad* worker = new CreateGamepad(info.Env());
+    worker->Queue();
+    return worker->GetPromise();
+}
+
+// Gamepad pool async implementation
+FillGamepadPool::FillGamepadPool(const Napi::Env& env, size_t count) : Napi::AsyncWorker{env, "FillGamepadPool"}, m_deferred{env}, m_count{count} {}
+
+FillGamepadPool::~FillGamepadPool() {
+    #if defined(IS_LINUX)
+        // Not moved into the pool
+        for (int fd : this->m_fds) {
+            GamepadDeviceClose(fd);
+        }
+    #endif
+}
+
+Napi::Promise FillGamepadPool::GetPromise() {
+    return m_deferred.Promise();
+}
+
+void FillGamepadPool::Execute() {
+    #if defined(IS_LINUX)
+        for (size_t i = 0; i < this->m_count; i++) {
+            int fd = GamepadDeviceOpen();
+            if (fd < 0) {
+                SetError(GamepadDeviceError());
+                return;
+            }
+            this->m_fds.push_back(fd);
+        }
+    #endif
+}
+
+void FillGamepadPool::OnOK() {
+    #if defined(IS_LINUX)
+        // Overlapping configurePool() calls may bring more devices than the pool takes
+        while (!this->m_fds.empty() && !gamepadPoolClosed && gamepadPool.size() < gamepadPoolSize) {
+            gamepadPool.push_back(this->m_fds.back());
+            this->m_fds.pop_back();
+        }
+        m_deferred.Resolve(Napi::Number::New(Env(), (double)gamepadPool.size()));
+    #endif
+}
+
+void FillGamepadPool::OnError(const Napi::Error& err) {
+    m_deferred.Reject(err.Value());
+}
+
+Napi::Value Gamepad::ConfigurePool(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected options object").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Napi::Value sizeVal = info[0].As<Napi::Object>().Get("size");
+    if (!sizeVal.IsNumber()) {
+        Napi::TypeError::New(env, "Expected number size option").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    int size = sizeVal.As<Napi::Number>().Int32Value();
+    if (size < 0 || size > 256) {
+        Napi::RangeError::New(env, "Pool size out of range (0-256)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    #if defined(IS_LINUX)
+        gamepadPoolSize = (size_t)size;
+
+        // Shrink right away, idle devices have nothing queued
+        while (gamepadPool.size() > gamepadPoolSize) {
+            GamepadDeviceClose(gamepadPool.back());
+            gamepadPool.pop_back();
+        }
+
+        FillGamepadPool* worker = new FillGamepadPool(env, gamepadPoolSize - gamepadPool.size());
+        worker->Queue();
+        return worker->GetPromise();
+    #else
+        Napi::Error::New(env, "Gamepad pool is not supported on this platform").ThrowAsJavaScriptException();
+        return env.Undefined();
+    #endif
+}
+
 Gamepad::Gamepad(const Napi::CallbackInfo& info) : Napi::ObjectWrap<Gamepad>(info) {
+    this->m_response = new GamepadResponse();
+
     #if defined(IS_WINDOWS)
         // allocate memory
         this->m_client = vigem_alloc();
@@ -122,130 +1316,22 @@ Gamepad::Gamepad(const Napi::CallbackInfo& info) : Napi::ObjectWrap<Gamepad>(inf
         }
 
     #elif defined(IS_LINUX)
-        // Linux specific initialization using uinput
-        // Try multiple possible paths for uinput
-        this->m_uinput_fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
-        if (this->m_uinput_fd < 0) {
-            // Try alternative path
-            this->m_uinput_fd = open("/dev/input/uinput", O_WRONLY | O_NONBLOCK);
+        // Linux specific initialization using uinput, a device made by createAsync() is adopted
+        // and create() takes an idle device from the pool first
+        if (info.Length() > 0 && info[0].IsExternal()) {
+            this->m_uinput_fd = *info[0].As<Napi::External<int>>().Data();
+        } else {
+            this->m_uinput_fd = GamepadPoolTake();
             if (this->m_uinput_fd < 0) {
-                // Try without O_NONBLOCK
-                this->m_uinput_fd = open("/dev/uinput", O_WRONLY);
-                if (this->m_uinput_fd < 0) {
-                    this->m_uinput_fd = open("/dev/input/uinput", O_WRONLY);
-                    if (this->m_uinput_fd < 0) {
-                        this->m_active = false;
-                        return;
-                    }
-                }
+                this->m_uinput_fd = GamepadDeviceOpen();
             }
         }
-
-        // Enable event types
-        if (ioctl(this->m_uinput_fd, UI_SET_EVBIT, EV_KEY) < 0) {
-            close(this->m_uinput_fd);
-            this->m_uinput_fd = -1;
-            this->m_active = false;
-            return;
-        }
-        
-        if (ioctl(this->m_uinput_fd, UI_SET_EVBIT, EV_ABS) < 0) {
-            close(this->m_uinput_fd);
-            this->m_uinput_fd = -1;
-            this->m_active = false;
-            return;
-        }
-
-        // Enable buttons (BTN_GAMEPAD + standard Xbox buttons)
-        ioctl(this->m_uinput_fd, UI_SET_KEYBIT, BTN_SOUTH);      // A
-        ioctl(this->m_uinput_fd, UI_SET_KEYBIT, BTN_EAST);       // B
-        ioctl(this->m_uinput_fd, UI_SET_KEYBIT, BTN_NORTH);      // X
-        ioctl(this->m_uinput_fd, UI_SET_KEYBIT, BTN_WEST);       // Y
-        ioctl(this->m_uinput_fd, UI_SET_KEYBIT, BTN_TL);         // LB
-        ioctl(this->m_uinput_fd, UI_SET_KEYBIT, BTN_TR);         // RB
-        ioctl(this->m_uinput_fd, UI_SET_KEYBIT, BTN_SELECT);     // Back
-        ioctl(this->m_uinput_fd, UI_SET_KEYBIT, BTN_START);      // Start
-        ioctl(this->m_uinput_fd, UI_SET_KEYBIT, BTN_MODE);       // Guide
-        ioctl(this->m_uinput_fd, UI_SET_KEYBIT, BTN_THUMBL);     // Left Stick
-        ioctl(this->m_uinput_fd, UI_SET_KEYBIT, BTN_THUMBR);     // Right Stick
-
-        // Enable axes
-        ioctl(this->m_uinput_fd, UI_SET_ABSBIT, ABS_X);          // Left stick X
-        ioctl(this->m_uinput_fd, UI_SET_ABSBIT, ABS_Y);          // Left stick Y
-        ioctl(this->m_uinput_fd, UI_SET_ABSBIT, ABS_RX);         // Right stick X
-        ioctl(this->m_uinput_fd, UI_SET_ABSBIT, ABS_RY);         // Right stick Y
-        ioctl(this->m_uinput_fd, UI_SET_ABSBIT, ABS_Z);          // Left trigger
-        ioctl(this->m_uinput_fd, UI_SET_ABSBIT, ABS_RZ);         // Right trigger
-        ioctl(this->m_uinput_fd, UI_SET_ABSBIT, ABS_HAT0X);      // D-pad X
-        ioctl(this->m_uinput_fd, UI_SET_ABSBIT, ABS_HAT0Y);      // D-pad Y
-
-        // Setup device
-        struct uinput_setup usetup;
-        memset(&usetup, 0, sizeof(usetup));
-        usetup.id.bustype = BUS_USB;
-        usetup.id.vendor = 0x045e;  // Microsoft
-        usetup.id.product = 0x028e; // Xbox 360 Controller
-        usetup.id.version = 1;
-        strncpy(usetup.name, "Virtual Xbox 360 Controller", UINPUT_MAX_NAME_SIZE);
-
-        // Configure axis ranges
-        struct uinput_abs_setup abs_setup;
-        memset(&abs_setup, 0, sizeof(abs_setup));
-        
-        // Left stick X
-        abs_setup.code = ABS_X;
-        abs_setup.absinfo.minimum = -32768;
-        abs_setup.absinfo.maximum = 32767;
-        abs_setup.absinfo.value = 0;
-        ioctl(this->m_uinput_fd, UI_ABS_SETUP, &abs_setup);
-        
-        // Left stick Y
-        abs_setup.code = ABS_Y;
-        ioctl(this->m_uinput_fd, UI_ABS_SETUP, &abs_setup);
-        
-        // Right stick X
-        abs_setup.code = ABS_RX;
-        ioctl(this->m_uinput_fd, UI_ABS_SETUP, &abs_setup);
-        
-        // Right stick Y
-        abs_setup.code = ABS_RY;
-        ioctl(this->m_uinput_fd, UI_ABS_SETUP, &abs_setup);
-        
-        // Triggers (0-255)
-        abs_setup.absinfo.minimum = 0;
-        abs_setup.absinfo.maximum = 255;
-        abs_setup.code = ABS_Z;
-        ioctl(this->m_uinput_fd, UI_ABS_SETUP, &abs_setup);
-        
-        abs_setup.code = ABS_RZ;
-        ioctl(this->m_uinput_fd, UI_ABS_SETUP, &abs_setup);
-        
-        // D-pad (-1, 0, 1)
-        abs_setup.absinfo.minimum = -1;
-        abs_setup.absinfo.maximum = 1;
-        abs_setup.code = ABS_HAT0X;
-        ioctl(this->m_uinput_fd, UI_ABS_SETUP, &abs_setup);
-        
-        abs_setup.code = ABS_HAT0Y;
-        ioctl(this->m_uinput_fd, UI_ABS_SETUP, &abs_setup);
-
-        // Create the device
-        if (ioctl(this->m_uinput_fd, UI_DEV_SETUP, &usetup) < 0) {
-            close(this->m_uinput_fd);
-            this->m_uinput_fd = -1;
-            this->m_active = false;
-            return;
-        }
-        
-        if (ioctl(this->m_uinput_fd, UI_DEV_CREATE) < 0) {
-            close(this->m_uinput_fd);
-            this->m_uinput_fd = -1;
+        if (this->m_uinput_fd < 0) {
             this->m_active = false;
             return;
         }
+        this->m_device_id = ServiceId(this->m_uinput_fd);
 
-        // Give the system time to create the device
-        usleep(100000); // 100ms delay
 
         // Allocate state tracking
         this->m_state = new GamepadState();
@@ -280,9 +1366,27 @@ Gamepad::~Gamepad() {
             this->m_gamepad_id = -1;
         }
     #elif defined(IS_LINUX)
+        if (this->m_replay != nullptr) {
+            // The replay thread writes the fd until it is joined, its promise is rejected later
+            GamepadReplayCancel(this->m_replay);
+            this->m_replay = nullptr;
+        }
+        if (this->m_isRecording) {
+            ServiceRecordStop(this->m_device_id, nullptr);
+            this->m_isRecording = false;
+        }
+        if (this->m_sharedState != nullptr) {
+            ServiceUnshare(this->m_device_id);
+            this->m_sharedState = nullptr;
+            this->m_shared.Reset();
+        }
         if (this->m_uinput_fd >= 0) {
-            ioctl(this->m_uinput_fd, UI_DEV_DESTROY);
-            close(this->m_uinput_fd);
+            // Queued events still reference this fd
+            Injector::Drain();
+            ServiceListen(this->m_device_id, nullptr, nullptr);
+            if (!GamepadPoolGive(this->m_uinput_fd, this->m_state)) {
+                GamepadDeviceClose(this->m_uinput_fd);
+            }
             this->m_uinput_fd = -1;
         }
         if (this->m_state != nullptr) {
@@ -290,6 +1394,16 @@ Gamepad::~Gamepad() {
             this->m_state = nullptr;
         }
     #endif
+
+    // the pump no longer reads it after ServiceUnshare
+    if (this->m_response != nullptr) {
+        delete this->m_response;
+        this->m_response = nullptr;
+    }
+}
+
+Napi::Value Gamepad::GetId(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), this->m_id);
 }
 
 Napi::Value Gamepad::IsActive(const Napi::CallbackInfo& info) {
@@ -297,23 +1411,164 @@ Napi::Value Gamepad::IsActive(const Napi::CallbackInfo& info) {
     return Napi::Boolean::New(env, this->m_active);
 }
 
-void Gamepad::Destroy(const Napi::CallbackInfo& info) {
-    Napi::Object thisObj = info.This().As<Napi::Object>();
-
-    // call destructor
-    this->~Gamepad();
-
-    // Find and remove from the gamepads vector
-    for (auto it = gamepads.begin(); it != gamepads.end(); ++it) {
-        if (it->Value() == thisObj) {
-            it->Reset();  // Release the persistent reference
-            gamepads.erase(it);
-            break;
-        }
+void Gamepad::Destroy(const Napi::CallbackInfo& info) {
+    // Free the registry slot, the id is invalid from now on
+    GamepadUnregister(this->m_id);
+    this->m_id = 0;
+
+    // call destructor
+    this->~Gamepad();
+}
+
+#if defined(IS_LINUX)
+bool Gamepad::ButtonCommand(int btnIndex, bool pressed, InjectCommand& command) {
+    // A shared gamepad is driven by the pump thread only, a replaying one by the replay thread
+    if (this->m_uinput_fd < 0 || this->m_sharedState != nullptr || this->m_replay != nullptr) {
+        return false;
+    }
+
+    command = {INJECT_UINPUT_EVENT, this->m_uinput_fd, EV_KEY, 0, pressed ? 1 : 0};
+
+    // Map button index to Linux input button codes
+    switch (btnIndex) {
+        case 0: case 1: case 2: case 3: case 4: case 5:
+        case 8: case 9: case 10: case 11: case 16:
+            command.c = GAMEPAD_BUTTON_CODES[btnIndex];
+            break;
+        case 12: // D-pad Up
+        case 13: // D-pad Down
+        case 14: // D-pad Left
+        case 15: // D-pad Right
+            // D-pad handled via HAT axes, release goes back to neutral
+            command.b = EV_ABS;
+            command.c = (btnIndex == 12 || btnIndex == 13) ? ABS_HAT0Y : ABS_HAT0X;
+            if (pressed) {
+                command.d = (btnIndex == 12 || btnIndex == 14) ? -1 : 1; // Up/Left : Down/Right
+            } else {
+                command.d = 0;
+            }
+            break;
+        case 6: // Left trigger
+        case 7: // Right trigger
+            // Trigger buttons press the analog trigger fully
+            command.b = EV_ABS;
+            command.c = btnIndex == 6 ? ABS_Z : ABS_RZ;
+            command.d = pressed ? 255 : 0;
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+bool Gamepad::AxisCommand(int axisIndex, double axisValue, InjectCommand& command) {
+    // A shared gamepad is driven by the pump thread only, a replaying one by the replay thread
+    if (this->m_uinput_fd < 0 || this->m_sharedState != nullptr || this->m_replay != nullptr) {
+        return false;
+    }
+
+    command = {INJECT_UINPUT_EVENT, this->m_uinput_fd, EV_ABS, 0, 0};
+    axisValue = GamepadAxisResponse(this->m_response, axisIndex, (float)axisValue);
+
+    // Convert normalized value (-1.0 to 1.0) to appropriate range
+    switch (axisIndex) {
+        case 0: // Left Stick X
+            command.c = ABS_X;
+            command.d = (int)(axisValue * 32767.0);
+            break;
+        case 1: // Left Stick Y
+            command.c = ABS_Y;
+            command.d = (int)(axisValue * 32767.0);
+            break;
+        case 2: // Right Stick X
+            command.c = ABS_RX;
+            command.d = (int)(axisValue * 32767.0);
+            break;
+        case 3: // Right Stick Y
+            command.c = ABS_RY;
+            command.d = (int)(axisValue * 32767.0);
+            break;
+        case 4: // Left Trigger
+            command.c = ABS_Z;
+            command.d = (int)((axisValue + 1.0) * 127.5);
+            break;
+        case 5: // Right Trigger
+            command.c = ABS_RZ;
+            command.d = (int)((axisValue + 1.0) * 127.5);
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+void Gamepad::StoreState(const InjectCommand& command) {
+    if (this->m_state == nullptr) {
+        return;
+    }
+
+    if (command.b == EV_KEY) {
+        for (int i = 0; i < 17; i++) {
+            if (GAMEPAD_BUTTON_CODES[i] != 0 && GAMEPAD_BUTTON_CODES[i] == command.c) {
+                if (command.d) {
+                    this->m_state->buttons |= 1u << i;
+                } else {
+                    this->m_state->buttons &= ~(1u << i);
+                }
+                break;
+            }
+        }
+    } else {
+        switch (command.c) {
+            case ABS_X: this->m_state->thumbLX = (short)command.d; break;
+            case ABS_Y: this->m_state->thumbLY = (short)command.d; break;
+            case ABS_RX: this->m_state->thumbRX = (short)command.d; break;
+            case ABS_RY: this->m_state->thumbRY = (short)command.d; break;
+            case ABS_Z: this->m_state->leftTrigger = (unsigned char)command.d; break;
+            case ABS_RZ: this->m_state->rightTrigger = (unsigned char)command.d; break;
+            case ABS_HAT0X: this->m_state->hatX = (signed char)command.d; break;
+            case ABS_HAT0Y: this->m_state->hatY = (signed char)command.d; break;
+        }
+    }
+    if (this->m_isRecording) {
+        ServiceRecord(this->m_device_id, *this->m_state);
+    }
+}
+
+bool Gamepad::EndReplay(const GamepadReplay* replay, const GamepadState& state) {
+    if (this->m_replay != replay) {
+        return false;
     }
+    this->m_replay = nullptr;
+    *this->m_state = state;
+    this->m_buttonMask = GamepadStateButtons(state);
+    return true;
+}
+#endif
 
-    
+#if defined(IS_WINDOWS)
+// Button index to Xbox 360 report bit, 0 for the triggers and unknown indexes
+static USHORT XusbButton(int btnIndex) {
+    switch (btnIndex) {
+        case 0: return XUSB_GAMEPAD_A;
+        case 1: return XUSB_GAMEPAD_B;
+        case 2: return XUSB_GAMEPAD_X;
+        case 3: return XUSB_GAMEPAD_Y;
+        case 4: return XUSB_GAMEPAD_LEFT_SHOULDER;
+        case 5: return XUSB_GAMEPAD_RIGHT_SHOULDER;
+        case 8: return XUSB_GAMEPAD_BACK;
+        case 9: return XUSB_GAMEPAD_START;
+        case 10: return XUSB_GAMEPAD_LEFT_THUMB;
+        case 11: return XUSB_GAMEPAD_RIGHT_THUMB;
+        case 12: return XUSB_GAMEPAD_DPAD_UP;
+        case 13: return XUSB_GAMEPAD_DPAD_DOWN;
+        case 14: return XUSB_GAMEPAD_DPAD_LEFT;
+        case 15: return XUSB_GAMEPAD_DPAD_RIGHT;
+        case 16: return XUSB_GAMEPAD_GUIDE;
+        default: return 0;
+    }
 }
+#endif
 
 void Gamepad::ButtonDown(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
@@ -336,7 +1591,14 @@ void Gamepad::ButtonDown(const Napi::CallbackInfo& info) {
 
     #if defined(IS_WINDOWS)
         USHORT buttonMask = 0;
-        switch (btnIndex) {
+        if (btnIndex == 6 || btnIndex == 7) {
+            // Trigger buttons press the analog trigger fully
+            if (btnIndex == 6) {
+                this->m_report->bLeftTrigger = 255;
+            } else {
+                this->m_report->bRightTrigger = 255;
+            }
+        } else switch (btnIndex) {
             case 0: buttonMask = XUSB_GAMEPAD_A; break;
             case 1: buttonMask = XUSB_GAMEPAD_B; break;
             case 2: buttonMask = XUSB_GAMEPAD_X; break;
@@ -352,8 +1614,6 @@ void Gamepad::ButtonDown(const Napi::CallbackInfo& info) {
             case 14: buttonMask = XUSB_GAMEPAD_DPAD_LEFT; break;
             case 15: buttonMask = XUSB_GAMEPAD_DPAD_RIGHT; break;
             case 16: buttonMask = XUSB_GAMEPAD_GUIDE; break;
-            case 6:
-            case 7:
             default:
                 Napi::RangeError::New(env, "Invalid button index").ThrowAsJavaScriptException();
                 return;
@@ -370,89 +1630,38 @@ void Gamepad::ButtonDown(const Napi::CallbackInfo& info) {
         }
     
     #elif defined(IS_MACOS)
-        BOOL result = [GamepadBridge buttonDown:this->m_gamepad_id button:btnIndex];
+        // Trigger buttons press the analog trigger fully
+        BOOL result = (btnIndex == 6 || btnIndex == 7) ?
+            [GamepadBridge setAxis:this->m_gamepad_id axis:btnIndex - 2 value:32767] :
+            [GamepadBridge buttonDown:this->m_gamepad_id button:btnIndex];
         if (!result) {
             Napi::Error::New(env, "Failed to update gamepad state").ThrowAsJavaScriptException();
             return;
         }
         
     #elif defined(IS_LINUX)
-        // Map button index to Linux input button codes
-        int buttonCode = -1;
-        switch (btnIndex) {
-            case 0: buttonCode = BTN_SOUTH; break;
-            case 1: buttonCode = BTN_EAST; break;
-            case 2: buttonCode = BTN_NORTH; break;
-            case 3: buttonCode = BTN_WEST; break;
-            case 4: buttonCode = BTN_TL; break;
-            case 5: buttonCode = BTN_TR; break;
-            case 8: buttonCode = BTN_SELECT; break;
-            case 9: buttonCode = BTN_START; break;
-            case 10: buttonCode = BTN_THUMBL; break;
-            case 11: buttonCode = BTN_THUMBR; break;
-            case 16: buttonCode = BTN_MODE; break;
-            case 12: // D-pad Up
-            case 13: // D-pad Down
-            case 14: // D-pad Left
-            case 15: // D-pad Right
-                // D-pad handled via HAT axes
-                {
-                    struct input_event ev[2];
-                    memset(ev, 0, sizeof(ev));
-                    
-                    if (btnIndex == 12) { // Up
-                        ev[0].type = EV_ABS;
-                        ev[0].code = ABS_HAT0Y;
-                        ev[0].value = -1;
-                    } else if (btnIndex == 13) { // Down
-                        ev[0].type = EV_ABS;
-                        ev[0].code = ABS_HAT0Y;
-                        ev[0].value = 1;
-                    } else if (btnIndex == 14) { // Left
-                        ev[0].type = EV_ABS;
-                        ev[0].code = ABS_HAT0X;
-                        ev[0].value = -1;
-                    } else if (btnIndex == 15) { // Right
-                        ev[0].type = EV_ABS;
-                        ev[0].code = ABS_HAT0X;
-                        ev[0].value = 1;
-                    }
-                    
-                    ev[1].type = EV_SYN;
-                    ev[1].code = SYN_REPORT;
-                    ev[1].value = 0;
-                    
-                    if (write(this->m_uinput_fd, ev, sizeof(ev)) < 0) {
-                        Napi::Error::New(env, "Failed to update gamepad state").ThrowAsJavaScriptException();
-                        return;
-                    }
-                }
-                return;
-            case 6:
-            case 7:
-            default:
-                Napi::RangeError::New(env, "Invalid button index").ThrowAsJavaScriptException();
-                return;
+        if (this->m_sharedState != nullptr) {
+            Napi::Error::New(env, "Gamepad state is shared, write the shared buffer instead").ThrowAsJavaScriptException();
+            return;
+        }
+        if (this->m_replay != nullptr) {
+            Napi::Error::New(env, "Gamepad is replaying a recording").ThrowAsJavaScriptException();
+            return;
+        }
+        InjectCommand command;
+        if (!this->ButtonCommand(btnIndex, true, command)) {
+            Napi::RangeError::New(env, "Invalid button index").ThrowAsJavaScriptException();
+            return;
         }
 
-        if (buttonCode >= 0) {
-            struct input_event ev[2];
-            memset(ev, 0, sizeof(ev));
-            
-            ev[0].type = EV_KEY;
-            ev[0].code = buttonCode;
-            ev[0].value = 1; // Press
-            
-            ev[1].type = EV_SYN;
-            ev[1].code = SYN_REPORT;
-            ev[1].value = 0;
-            
-            if (write(this->m_uinput_fd, ev, sizeof(ev)) < 0) {
-                Napi::Error::New(env, "Failed to update gamepad state").ThrowAsJavaScriptException();
-                return;
-            }
+        if (!Injector::Submit(command)) {
+            Napi::Error::New(env, "Failed to update gamepad state").ThrowAsJavaScriptException();
+            return;
         }
+        this->StoreState(command);
     #endif
+
+    this->m_buttonMask |= 1u << btnIndex;
 }
 
 void Gamepad::ButtonUp(const Napi::CallbackInfo& info) {
@@ -479,7 +1688,14 @@ void Gamepad::ButtonUp(const Napi::CallbackInfo& info) {
         // Windows specific button down implementation
         // Map button index to Xbox 360 button
         USHORT buttonMask = 0;
-        switch (btnIndex) {
+        if (btnIndex == 6 || btnIndex == 7) {
+            // Trigger buttons release the analog trigger
+            if (btnIndex == 6) {
+                this->m_report->bLeftTrigger = 0;
+            } else {
+                this->m_report->bRightTrigger = 0;
+            }
+        } else switch (btnIndex) {
             case 0: buttonMask = XUSB_GAMEPAD_A; break;
             case 1: buttonMask = XUSB_GAMEPAD_B; break;
             case 2: buttonMask = XUSB_GAMEPAD_X; break;
@@ -495,8 +1711,6 @@ void Gamepad::ButtonUp(const Napi::CallbackInfo& info) {
             case 14: buttonMask = XUSB_GAMEPAD_DPAD_LEFT; break;
             case 15: buttonMask = XUSB_GAMEPAD_DPAD_RIGHT; break;
             case 16: buttonMask = XUSB_GAMEPAD_GUIDE; break;
-            case 6:
-            case 7:
             default:
                 Napi::RangeError::New(env, "Invalid button index").ThrowAsJavaScriptException();
                 return;
@@ -513,7 +1727,9 @@ void Gamepad::ButtonUp(const Napi::CallbackInfo& info) {
         }
     
     #elif defined(IS_MACOS)
-        BOOL result = [GamepadBridge buttonUp:this->m_gamepad_id button:btnIndex];
+        BOOL result = (btnIndex == 6 || btnIndex == 7) ?
+            [GamepadBridge setAxis:this->m_gamepad_id axis:btnIndex - 2 value:-32767] :
+            [GamepadBridge buttonUp:this->m_gamepad_id button:btnIndex];
         if (!result) {
             Napi::Error::New(env, "Failed to update gamepad state").ThrowAsJavaScriptException();
             return;
@@ -521,74 +1737,28 @@ void Gamepad::ButtonUp(const Napi::CallbackInfo& info) {
         
         
     #elif defined(IS_LINUX)
-        // Map button index to Linux input button codes
-        int buttonCode = -1;
-        switch (btnIndex) {
-            case 0: buttonCode = BTN_SOUTH; break;
-            case 1: buttonCode = BTN_EAST; break;
-            case 2: buttonCode = BTN_NORTH; break;
-            case 3: buttonCode = BTN_WEST; break;
-            case 4: buttonCode = BTN_TL; break;
-            case 5: buttonCode = BTN_TR; break;
-            case 8: buttonCode = BTN_SELECT; break;
-            case 9: buttonCode = BTN_START; break;
-            case 10: buttonCode = BTN_THUMBL; break;
-            case 11: buttonCode = BTN_THUMBR; break;
-            case 16: buttonCode = BTN_MODE; break;
-            case 12: // D-pad Up
-            case 13: // D-pad Down
-            case 14: // D-pad Left
-            case 15: // D-pad Right
-                // D-pad handled via HAT axes - release to neutral
-                {
-                    struct input_event ev[3];
-                    memset(ev, 0, sizeof(ev));
-                    
-                    if (btnIndex == 12 || btnIndex == 13) { // Up/Down
-                        ev[0].type = EV_ABS;
-                        ev[0].code = ABS_HAT0Y;
-                        ev[0].value = 0;
-                    } else { // Left/Right
-                        ev[0].type = EV_ABS;
-                        ev[0].code = ABS_HAT0X;
-                        ev[0].value = 0;
-                    }
-                    
-                    ev[1].type = EV_SYN;
-                    ev[1].code = SYN_REPORT;
-                    ev[1].value = 0;
-                    
-                    if (write(this->m_uinput_fd, ev, sizeof(ev)) < 0) {
-                        Napi::Error::New(env, "Failed to update gamepad state").ThrowAsJavaScriptException();
-                        return;
-                    }
-                }
-                return;
-            case 6:
-            case 7:
-            default:
-                Napi::RangeError::New(env, "Invalid button index").ThrowAsJavaScriptException();
-                return;
+        if (this->m_sharedState != nullptr) {
+            Napi::Error::New(env, "Gamepad state is shared, write the shared buffer instead").ThrowAsJavaScriptException();
+            return;
+        }
+        if (this->m_replay != nullptr) {
+            Napi::Error::New(env, "Gamepad is replaying a recording").ThrowAsJavaScriptException();
+            return;
+        }
+        InjectCommand command;
+        if (!this->ButtonCommand(btnIndex, false, command)) {
+            Napi::RangeError::New(env, "Invalid button index").ThrowAsJavaScriptException();
+            return;
         }
 
-        if (buttonCode >= 0) {
-            struct input_event ev[2];
-            memset(ev, 0, sizeof(ev));
-            
-            ev[0].type = EV_KEY;
-            ev[0].code = buttonCode;
-            ev[0].value = 0; // Release
-            
-            ev[1].type = EV_SYN;
-            ev[1].code = SYN_REPORT;
-            ev[1].value = 0;
-            
-            if (write(this->m_uinput_fd, ev, sizeof(ev)) < 0) {
-                Napi::Error::New(env, "Failed to update gamepad state").ThrowAsJavaScriptException();
-                return;
-            }
+        if (!Injector::Submit(command)) {
+            Napi::Error::New(env, "Failed to update gamepad state").ThrowAsJavaScriptException();
+            return;
         }
+        this->StoreState(command);
     #endif
+
+    this->m_buttonMask &= ~(1u << btnIndex);
 }
 
 void Gamepad::SetAxis(const Napi::CallbackInfo& info) {
@@ -610,6 +1780,8 @@ void Gamepad::SetAxis(const Napi::CallbackInfo& info) {
     }
 
     #if defined(IS_WINDOWS)
+        axisValue = GamepadAxisResponse(this->m_response, axisIndex, (float)axisValue);
+
         // Convert normalized value (-1.0 to 1.0) to Xbox 360 range
         SHORT value = (SHORT)(axisValue * 32767.0);
 
@@ -647,6 +1819,8 @@ void Gamepad::SetAxis(const Napi::CallbackInfo& info) {
             return;
         }
     #elif defined(IS_MACOS)
+        axisValue = GamepadAxisResponse(this->m_response, axisIndex, (float)axisValue);
+
         // Convert normalized value (-1.0 to 1.0) to int16 range (-32768 to 32767)
         int value = (int)(axisValue * 32767.0);
         
@@ -657,64 +1831,502 @@ void Gamepad::SetAxis(const Napi::CallbackInfo& info) {
         }
         
     #elif defined(IS_LINUX)
-        // Convert normalized value (-1.0 to 1.0) to appropriate range
-        struct input_event ev[2];
-        memset(ev, 0, sizeof(ev));
-        
-        ev[0].type = EV_ABS;
-        
-        switch (axisIndex) {
-            case 0: // Left Stick X
-                ev[0].code = ABS_X;
-                ev[0].value = (int)(axisValue * 32767.0);
-                break;
-            case 1: // Left Stick Y
-                ev[0].code = ABS_Y;
-                ev[0].value = (int)(axisValue * 32767.0);
-                break;
-            case 2: // Right Stick X
-                ev[0].code = ABS_RX;
-                ev[0].value = (int)(axisValue * 32767.0);
-                break;
-            case 3: // Right Stick Y
-                ev[0].code = ABS_RY;
-                ev[0].value = (int)(axisValue * 32767.0);
-                break;
-            case 4: // Left Trigger
-                ev[0].code = ABS_Z;
-                ev[0].value = (int)((axisValue + 1.0) * 127.5);
-                break;
-            case 5: // Right Trigger
-                ev[0].code = ABS_RZ;
-                ev[0].value = (int)((axisValue + 1.0) * 127.5);
-                break;
-            default:
-                Napi::RangeError::New(env, "Invalid axis index").ThrowAsJavaScriptException();
-                return;
+        if (this->m_sharedState != nullptr) {
+            Napi::Error::New(env, "Gamepad state is shared, write the shared buffer instead").ThrowAsJavaScriptException();
+            return;
+        }
+        if (this->m_replay != nullptr) {
+            Napi::Error::New(env, "Gamepad is replaying a recording").ThrowAsJavaScriptException();
+            return;
+        }
+        InjectCommand command;
+        if (!this->AxisCommand(axisIndex, axisValue, command)) {
+            Napi::RangeError::New(env, "Invalid axis index").ThrowAsJavaScriptException();
+            return;
         }
         
-        ev[1].type = EV_SYN;
-        ev[1].code = SYN_REPORT;
-        ev[1].value = 0;
-        
-        if (write(this->m_uinput_fd, ev, sizeof(ev)) < 0) {
+        if (!Injector::Submit(command)) {
+            Napi::Error::New(env, "Failed to update gamepad state").ThrowAsJavaScriptException();
+            return;
+        }
+        this->StoreState(command);
+    #endif
+}
+
+
+
+void Gamepad::SetState(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!this->m_active) {
+        Napi::Error::New(env, "Gamepad is not active").ThrowAsJavaScriptException();
+        return;
+    }
+
+    if (info.Length() < 2 || !info[0].IsTypedArray() || !info[1].IsNumber() ||
+        info[0].As<Napi::TypedArray>().TypedArrayType() != napi_float32_array) {
+        Napi::TypeError::New(env, "Float32Array axes and button mask expected").ThrowAsJavaScriptException();
+        return;
+    }
+    Napi::Float32Array axesArr = info[0].As<Napi::Float32Array>();
+    uint32_t buttonMask = info[1].As<Napi::Number>().Uint32Value();
+
+    // Axes past the end of the array keep their value
+    size_t axisCount = axesArr.ElementLength() < 6 ? axesArr.ElementLength() : 6;
+    float axes[6];
+    for (size_t i = 0; i < axisCount; i++) {
+        axes[i] = axesArr[i];
+        if (!(axes[i] >= -1.0f && axes[i] <= 1.0f)) {
+            Napi::RangeError::New(env, "Axis value out of range (-1.0 to 1.0)").ThrowAsJavaScriptException();
+            return;
+        }
+    }
+    if ((buttonMask & ~GAMEPAD_BUTTON_MASK) != 0) {
+        Napi::RangeError::New(env, "Invalid button index in mask").ThrowAsJavaScriptException();
+        return;
+    }
+
+    uint32_t axisMask = (1u << axisCount) - 1;
+    for (size_t i = 0; i < axisCount; i++) {
+        axes[i] = GamepadAxisResponse(this->m_response, (int)i, axes[i]);
+    }
+    GamepadTriggerButtons(axes, axisMask, buttonMask, this->m_buttonMask);
+
+    #if defined(IS_WINDOWS)
+        // The whole report goes out with one update
+        USHORT buttons = 0;
+        for (int i = 0; i < 17; i++) {
+            if (buttonMask & (1u << i)) {
+                buttons |= XusbButton(i);
+            }
+        }
+        this->m_report->wButtons = buttons;
+
+        for (int i = 0; i < 6; i++) {
+            if ((axisMask & (1u << i)) == 0) {
+                continue;
+            }
+            SHORT value = (SHORT)(axes[i] * 32767.0);
+            switch (i) {
+                case 0: this->m_report->sThumbLX = value; break;
+                case 1: this->m_report->sThumbLY = -value; break;
+                case 2: this->m_report->sThumbRX = value; break;
+                case 3: this->m_report->sThumbRY = -value; break;
+                case 4: this->m_report->bLeftTrigger = (BYTE)((axes[i] + 1.0) * 127.5); break;
+                case 5: this->m_report->bRightTrigger = (BYTE)((axes[i] + 1.0) * 127.5); break;
+            }
+        }
+
+        const auto result = vigem_target_x360_update(this->m_client, this->m_pad, *this->m_report);
+        if (!VIGEM_SUCCESS(result)) {
+            Napi::Error::New(env, "Failed to update gamepad state").ThrowAsJavaScriptException();
+            return;
+        }
+    #elif defined(IS_MACOS)
+        // The bridge has no state update, send every axis and button one by one
+        BOOL result = YES;
+        for (int i = 0; i < 6; i++) {
+            if (axisMask & (1u << i)) {
+                result = result && [GamepadBridge setAxis:this->m_gamepad_id axis:i value:(int)(axes[i] * 32767.0)];
+            }
+        }
+        for (int i = 0; i < 17; i++) {
+            // Trigger buttons went out as axes
+            if (i == 6 || i == 7) {
+                continue;
+            }
+            if (buttonMask & (1u << i)) {
+                result = result && [GamepadBridge buttonDown:this->m_gamepad_id button:i];
+            } else {
+                result = result && [GamepadBridge buttonUp:this->m_gamepad_id button:i];
+            }
+        }
+        if (!result) {
             Napi::Error::New(env, "Failed to update gamepad state").ThrowAsJavaScriptException();
             return;
         }
+
+    #elif defined(IS_LINUX)
+        if (this->m_sharedState != nullptr) {
+            Napi::Error::New(env, "Gamepad state is shared, write the shared buffer instead").ThrowAsJavaScriptException();
+            return;
+        }
+        if (this->m_replay != nullptr) {
+            Napi::Error::New(env, "Gamepad is replaying a recording").ThrowAsJavaScriptException();
+            return;
+        }
+        GamepadState next = *this->m_state;
+        GamepadStateSet(next, axes, axisMask, buttonMask);
+
+        // Only the changed values, they all end up in one frame with a single SYN_REPORT
+        struct input_event events[GAMEPAD_MAX_EVENTS];
+        size_t count = GamepadStateDiff(*this->m_state, next, events);
+        for (size_t i = 0; i < count; i++) {
+            InjectCommand command = {i + 1 < count ? INJECT_UINPUT_EVENT_CONT : INJECT_UINPUT_EVENT,
+                this->m_uinput_fd, events[i].type, events[i].code, events[i].value};
+            if (!Injector::Submit(command)) {
+                Napi::Error::New(env, "Failed to update gamepad state").ThrowAsJavaScriptException();
+                return;
+            }
+        }
+        *this->m_state = next;
+        if (this->m_isRecording) {
+            ServiceRecord(this->m_device_id, next);
+        }
+    #endif
+
+    this->m_buttonMask = buttonMask;
+}
+
+
+void Gamepad::On(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Event name and listener expected").ThrowAsJavaScriptException();
+        return;
+    }
+    if (!info[1].IsFunction() && !info[1].IsNull()) {
+        Napi::TypeError::New(env, "Expected function or null listener").ThrowAsJavaScriptException();
+        return;
+    }
+    if (info[0].As<Napi::String>().Utf8Value() != "rumble") {
+        Napi::TypeError::New(env, "Unknown event, expected 'rumble'").ThrowAsJavaScriptException();
+        return;
+    }
+
+    #if defined(IS_LINUX)
+        if (this->m_uinput_fd < 0) {
+            Napi::Error::New(env, "Gamepad is not active").ThrowAsJavaScriptException();
+            return;
+        }
+
+        // Replace the previous listener
+        if (info[1].IsNull()) {
+            ServiceListen(this->m_device_id, nullptr, nullptr);
+        } else {
+            Napi::Function callback = info[1].As<Napi::Function>();
+            ServiceListen(this->m_device_id, &env, &callback);
+        }
+    #else
+        if (!info[1].IsNull()) {
+            Napi::Error::New(env, "Rumble events are not supported on this platform").ThrowAsJavaScriptException();
+            return;
+        }
+    #endif
+}
+
+void Gamepad::SetAxisResponse(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected options object").ThrowAsJavaScriptException();
+        return;
+    }
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    // Omitted options go back to their defaults
+    GamepadResponse response;
+    const char* fractions[2] = {"deadzone", "smoothing"};
+    float* targets[2] = {&response.deadzone, &response.smoothing};
+    for (int i = 0; i < 2; i++) {
+        Napi::Value value = options.Get(fractions[i]);
+        if (value.IsUndefined()) {
+            continue;
+        }
+        if (!value.IsNumber()) {
+            Napi::TypeError::New(env, std::string("Expected number ") + fractions[i] + " option").ThrowAsJavaScriptException();
+            return;
+        }
+        double fraction = value.As<Napi::Number>().DoubleValue();
+        if (!(fraction >= 0.0 && fraction < 1.0)) {
+            Napi::RangeError::New(env, std::string(fractions[i]) + " out of range (0 to below 1)").ThrowAsJavaScriptException();
+            return;
+        }
+        *targets[i] = (float)fraction;
+    }
+
+    Napi::Value curvesVal = options.Get("curves");
+    if (!curvesVal.IsUndefined()) {
+        if (!curvesVal.IsArray() || curvesVal.As<Napi::Array>().Length() > 6) {
+            Napi::TypeError::New(env, "Expected array of up to 6 curves").ThrowAsJavaScriptException();
+            return;
+        }
+        Napi::Array curves = curvesVal.As<Napi::Array>();
+        for (uint32_t axis = 0; axis < curves.Length(); axis++) {
+            Napi::Value curve = curves.Get(axis);
+            if (curve.IsUndefined()) {
+                continue;
+            }
+            if (curve.IsString()) {
+                std::string name = curve.As<Napi::String>().Utf8Value();
+                if (name == "linear") {
+                    response.curves[axis] = GAMEPAD_CURVE_LINEAR;
+                } else if (name == "quadratic") {
+                    response.curves[axis] = GAMEPAD_CURVE_QUADRATIC;
+                } else {
+                    Napi::TypeError::New(env, "Unknown curve, expected 'linear', 'quadratic' or a lookup table").ThrowAsJavaScriptException();
+                    return;
+                }
+                continue;
+            }
+
+            // Lookup table as an array or a Float32Array of evenly spaced points
+            std::vector<float>& lut = response.luts[axis];
+            if (curve.IsArray()) {
+                Napi::Array points = curve.As<Napi::Array>();
+                for (uint32_t i = 0; i < points.Length(); i++) {
+                    Napi::Value point = points.Get(i);
+                    lut.push_back(point.IsNumber() ? point.As<Napi::Number>().FloatValue() : NAN);
+                }
+            } else if (curve.IsTypedArray() && curve.As<Napi::TypedArray>().TypedArrayType() == napi_float32_array) {
+                Napi::Float32Array points = curve.As<Napi::Float32Array>();
+                lut.assign(points.Data(), points.Data() + points.ElementLength());
+            } else {
+                Napi::TypeError::New(env, "Expected curve name or lookup table").ThrowAsJavaScriptException();
+                return;
+            }
+            if (lut.size() < 2 || lut.size() > 4096) {
+                Napi::RangeError::New(env, "Lookup table needs 2 to 4096 points").ThrowAsJavaScriptException();
+                return;
+            }
+            for (float point : lut) {
+                if (!(point >= 0.0f && point <= 1.0f)) {
+                    Napi::RangeError::New(env, "Lookup table point out of range (0.0 to 1.0)").ThrowAsJavaScriptException();
+                    return;
+                }
+            }
+            response.curves[axis] = GAMEPAD_CURVE_LUT;
+        }
+    }
+
+    if (this->m_response == nullptr) {
+        Napi::Error::New(env, "Gamepad is not active").ThrowAsJavaScriptException();
+        return;
+    }
+    #if defined(IS_LINUX)
+        // The pump thread reads the filters of a shared gamepad
+        std::lock_guard<std::mutex> lock(serviceMutex);
+    #endif
+    *this->m_response = std::move(response);
+}
+
+void Gamepad::StartRecording(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!this->m_active) {
+        Napi::Error::New(env, "Gamepad is not active").ThrowAsJavaScriptException();
+        return;
+    }
+
+    #if defined(IS_LINUX)
+        if (this->m_isRecording) {
+            Napi::Error::New(env, "Gamepad is already recording").ThrowAsJavaScriptException();
+            return;
+        }
+        if (!ServiceRecordStart(this->m_device_id, this->m_state)) {
+            Napi::Error::New(env, "Failed to start gamepad recording").ThrowAsJavaScriptException();
+            return;
+        }
+        this->m_isRecording = true;
+    #else
+        Napi::Error::New(env, "Gamepad recording is not supported on this platform").ThrowAsJavaScriptException();
+    #endif
+}
+
+Napi::Value Gamepad::StopRecording(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    #if defined(IS_LINUX)
+        if (!this->m_isRecording) {
+            Napi::Error::New(env, "Gamepad is not recording").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        std::vector<uint8_t> log;
+        ServiceRecordStop(this->m_device_id, &log);
+        this->m_isRecording = false;
+
+        Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, log.size());
+        memcpy(buffer.Data(), log.data(), log.size());
+        return buffer;
+    #else
+        Napi::Error::New(env, "Gamepad recording is not supported on this platform").ThrowAsJavaScriptException();
+        return env.Undefined();
+    #endif
+}
+
+Napi::Value Gamepad::Replay(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!this->m_active) {
+        Napi::Error::New(env, "Gamepad is not active").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    if (info.Length() > 0 && info[0].IsArrayBuffer()) {
+        Napi::ArrayBuffer buffer = info[0].As<Napi::ArrayBuffer>();
+        data = (const uint8_t*)buffer.Data();
+        size = buffer.ByteLength();
+    } else if (info.Length() > 0 && info[0].IsTypedArray() && info[0].As<Napi::TypedArray>().TypedArrayType() == napi_uint8_array) {
+        Napi::Uint8Array bytes = info[0].As<Napi::Uint8Array>();
+        data = bytes.Data();
+        size = bytes.ByteLength();
+    } else {
+        Napi::TypeError::New(env, "Recording ArrayBuffer or Uint8Array expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    double speed = 1.0;
+    if (info.Length() > 1 && !info[1].IsUndefined()) {
+        if (!info[1].IsObject()) {
+            Napi::TypeError::New(env, "Expected options object").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        Napi::Value speedVal = info[1].As<Napi::Object>().Get("speed");
+        if (!speedVal.IsUndefined()) {
+            if (!speedVal.IsNumber()) {
+                Napi::TypeError::New(env, "Expected number speed option").ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+            speed = speedVal.As<Napi::Number>().DoubleValue();
+            if (!(speed > 0.0 && speed <= 100.0)) {
+                Napi::RangeError::New(env, "Speed out of range (above 0 to 100)").ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+        }
+    }
+
+    #if defined(IS_LINUX)
+        if (this->m_sharedState != nullptr) {
+            Napi::Error::New(env, "Gamepad state is shared, write the shared buffer instead").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        if (this->m_replay != nullptr) {
+            Napi::Error::New(env, "Gamepad is already replaying a recording").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        GamepadReplay* replay = new GamepadReplay(env);
+        if (!GamepadRecordingParse(data, size, *this->m_state, replay->frames)) {
+            delete replay;
+            Napi::RangeError::New(env, "Invalid gamepad recording").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        // Queued input goes out first, the thread owns the device state from here on
+        Injector::Drain();
+        replay->fd = this->m_uinput_fd;
+        replay->deviceId = this->m_device_id;
+        replay->speed = speed;
+        replay->state = *this->m_state;
+        replay->gamepad = this;
+        replay->gamepadRef = Napi::Persistent(info.This().As<Napi::Object>());
+        replay->tsfn = Napi::ThreadSafeFunction::New(env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}), "GamepadReplay", 0, 1);
+        Napi::Promise promise = replay->deferred.Promise();
+
+        this->m_replay = replay;
+        gamepadReplays.push_back(replay);
+        replay->thread = std::thread(GamepadReplayRun, replay);
+        return promise;
+    #else
+        Napi::Error::New(env, "Gamepad recording is not supported on this platform").ThrowAsJavaScriptException();
+        return env.Undefined();
+    #endif
+}
+
+Napi::Value Gamepad::ShareState(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!this->m_active) {
+        Napi::Error::New(env, "Gamepad is not active").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    #if defined(IS_LINUX)
+        if (this->m_sharedState != nullptr) {
+            return this->m_shared.Value();
+        }
+        if (this->m_replay != nullptr) {
+            Napi::Error::New(env, "Gamepad is replaying a recording").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        // N-API cannot make a SharedArrayBuffer, construct it in JS and reach the memory through a view
+        Napi::Value sab = env.Global().Get("SharedArrayBuffer").As<Napi::Function>().New({Napi::Number::New(env, sizeof(GamepadSharedState))});
+        if (env.IsExceptionPending()) {
+            return env.Undefined();
+        }
+        Napi::Value view = env.Global().Get("Int32Array").As<Napi::Function>().New({sab});
+        if (env.IsExceptionPending()) {
+            return env.Undefined();
+        }
+        void* data = nullptr;
+        if (napi_get_typedarray_info(env, view, nullptr, nullptr, &data, nullptr, nullptr) != napi_ok || data == nullptr) {
+            Napi::Error::New(env, "Failed to share gamepad state").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        // Start from the current state, so the first sample does not reset the gamepad
+        GamepadSharedState* block = (GamepadSharedState*)data;
+        const GamepadState* state = this->m_state;
+        block->sequence = 0;
+        block->applied = 0;
+        block->buttons = GamepadStateButtons(*state);
+        block->axes[0] = state->thumbLX / 32767.0f;
+        block->axes[1] = state->thumbLY / 32767.0f;
+        block->axes[2] = state->thumbRX / 32767.0f;
+        block->axes[3] = state->thumbRY / 32767.0f;
+        block->axes[4] = state->leftTrigger / 127.5f - 1.0f;
+        block->axes[5] = state->rightTrigger / 127.5f - 1.0f;
+
+        if (!ServiceShare(this->m_device_id, this->m_state, this->m_response, block)) {
+            Napi::Error::New(env, "Failed to share gamepad state").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        this->m_shared = Napi::Persistent(sab.As<Napi::Object>());
+        this->m_sharedState = block;
+        return sab;
+    #else
+        Napi::Error::New(env, "Shared gamepad state is not supported on this platform").ThrowAsJavaScriptException();
+        return env.Undefined();
     #endif
 }
 
+void Gamepad::SetPumpRate(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Rate in Hz expected").ThrowAsJavaScriptException();
+        return;
+    }
+    int rate = info[0].As<Napi::Number>().Int32Value();
+    if (rate < 1 || rate > 8000) {
+        Napi::RangeError::New(env, "Rate out of range (1-8000)").ThrowAsJavaScriptException();
+        return;
+    }
 
+    #if defined(IS_LINUX)
+        ServiceSetRate(rate);
+    #else
+        Napi::Error::New(env, "Shared gamepad state is not supported on this platform").ThrowAsJavaScriptException();
+    #endif
+}
 
 Napi::Object Gamepad::Init(Napi::Env env, Napi::Object exports) {
     Napi::Object obj = Napi::Object::New(env);
 
     obj.Set(Napi::String::New(env, "list"), Napi::Function::New(env, Gamepad::list));
+    obj.Set(Napi::String::New(env, "get"), Napi::Function::New(env, Gamepad::Get));
     
     // object create
     Napi::Object new_exports = Napi::Function::New(env, Gamepad::CreateObject);
 
     obj.Set(Napi::String::New(env, "create"), new_exports);
+    obj.Set(Napi::String::New(env, "createAsync"), Napi::Function::New(env, Gamepad::CreateAsync));
+    obj.Set(Napi::String::New(env, "configurePool"), Napi::Function::New(env, Gamepad::ConfigurePool));
+    obj.Set(Napi::String::New(env, "setPumpRate"), Napi::Function::New(env, Gamepad::SetPumpRate));
 
     Napi::Function func = DefineClass(env,
         "Gamepad",
@@ -723,7 +2335,15 @@ Napi::Object Gamepad::Init(Napi::Env env, Napi::Object exports) {
             InstanceMethod("destroy", &Gamepad::Destroy),
             InstanceMethod("buttonDown", &Gamepad::ButtonDown),
             InstanceMethod("buttonUp", &Gamepad::ButtonUp),
-            InstanceMethod("setAxis", &Gamepad::SetAxis)
+            InstanceMethod("setAxis", &Gamepad::SetAxis),
+            InstanceMethod("setState", &Gamepad::SetState),
+            InstanceMethod("shareState", &Gamepad::ShareState),
+            InstanceMethod("setAxisResponse", &Gamepad::SetAxisResponse),
+            InstanceMethod("startRecording", &Gamepad::StartRecording),
+            InstanceMethod("stopRecording", &Gamepad::StopRecording),
+            InstanceMethod("replay", &Gamepad::Replay),
+            InstanceMethod("on", &Gamepad::On),
+            InstanceAccessor("id", &Gamepad::GetId, nullptr)
         }
     );
 
@@ -732,5 +2352,20 @@ Napi::Object Gamepad::Init(Napi::Env env, Napi::Object exports) {
     env.SetInstanceData(constructor);
 
     new_exports.Set("Gamepad", func);
+
+    #if defined(IS_LINUX)
+        // Stop the service and replay threads and remove the idle devices before the environment goes away
+        napi_add_env_cleanup_hook(env, [](void* arg) {
+            for (GamepadReplay* replay : gamepadReplays) {
+                GamepadReplayCancel(replay);
+            }
+            ServiceStop();
+            gamepadPoolClosed = true;
+            while (!gamepadPool.empty()) {
+                GamepadDeviceClose(gamepadPool.back());
+                gamepadPool.pop_back();
+            }
+        }, nullptr);
+    #endif
     return obj;
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include <napi.h>
 #include <vector>
 
+#include "injector.h"
+
 #if defined(IS_WINDOWS)
     // Opaque pointer - the actual type is defined in the .cpp file
     typedef struct _VIGEM_CLIENT_T* PVIGEM_CLIENT;
@@ -21,7 +23,7 @@
     // Linux uinput file descriptor
     typedef int UINPUT_FD;
     
-    // Structure to track gamepad state
+    // Structure to track gamepad state, values as last sent to the device
     struct GamepadState {
         short thumbLX;
         short thumbLY;
@@ -29,10 +31,39 @@
         short thumbRY;
         unsigned char leftTrigger;
         unsigned char rightTrigger;
-        unsigned short buttons;
+        unsigned int buttons;   // bit per button index, without the d-pad
+        signed char hatX;       // d-pad -1 left, 1 right
+        signed char hatY;       // d-pad -1 up, 1 down
+    };
+
+    // Layout of the shareState() buffer, written by JS and sampled by the pump thread
+    struct GamepadSharedState {
+        int32_t sequence;       // odd while JS writes the block
+        uint32_t buttons;       // setState button mask
+        float axes[6];          // setState axes
+        int32_t applied;        // last sequence sent to the device, written by the pump
     };
+
+    // A running replay() of a recording, owned by its thread until the promise settles
+    struct GamepadReplay;
 #endif
 
+// Response curve of one axis
+enum GamepadCurve {
+    GAMEPAD_CURVE_LINEAR = 0,
+    GAMEPAD_CURVE_QUADRATIC = 1,
+    GAMEPAD_CURVE_LUT = 2       // linear interpolation between evenly spaced points
+};
+
+// setAxisResponse() filters, applied in setAxis, setState and the shared state pump
+struct GamepadResponse {
+    float deadzone = 0.0f;      // 0 to 1 of the stick axis or trigger travel
+    float smoothing = 0.0f;     // 0 to 1 of the previous value kept per pump tick
+    GamepadCurve curves[6] = {GAMEPAD_CURVE_LINEAR, GAMEPAD_CURVE_LINEAR, GAMEPAD_CURVE_LINEAR,
+        GAMEPAD_CURVE_LINEAR, GAMEPAD_CURVE_LINEAR, GAMEPAD_CURVE_LINEAR};
+    std::vector<float> luts[6];
+};
+
 class InstallDriver : public Napi::AsyncWorker {
     public:
         InstallDriver(const Napi::Env& env);
@@ -49,21 +80,87 @@ class InstallDriver : public Napi::AsyncWorker {
 
 };
 
+// Gamepad.createAsync(), the device setup runs on the threadpool
+class CreateGamepad : public Napi::AsyncWorker {
+    public:
+        CreateGamepad(const Napi::Env& env);
+        ~CreateGamepad();
+        Napi::Promise GetPromise();
+
+    protected:
+        void Execute();
+        void OnOK();
+        void OnError(const Napi::Error& e);
+
+    private:
+        Napi::Promise::Deferred m_deferred;
+        #if defined(IS_LINUX)
+            int m_uinput_fd = -1;
+        #endif
+};
+
+// Gamepad.configurePool(), creates the idle devices on the threadpool
+class FillGamepadPool : public Napi::AsyncWorker {
+    public:
+        FillGamepadPool(const Napi::Env& env, size_t count);
+        ~FillGamepadPool();
+        Napi::Promise GetPromise();
+
+    protected:
+        void Execute();
+        void OnOK();
+        void OnError(const Napi::Error& e);
+
+    private:
+        Napi::Promise::Deferred m_deferred;
+        size_t m_count;
+        std::vector<int> m_fds;
+};
+
 class Gamepad : public Napi::ObjectWrap<Gamepad> {
     public:
         static Napi::Object Init(Napi::Env env, Napi::Object exports);
         static Napi::Value list(const Napi::CallbackInfo& info);
+        static Napi::Value Get(const Napi::CallbackInfo& info);
         static Napi::Object CreateObject(const Napi::CallbackInfo& info);
-        static Napi::Object NewInstance(Napi::Env env);
+        static Napi::Promise CreateAsync(const Napi::CallbackInfo& info);
+        static Napi::Value ConfigurePool(const Napi::CallbackInfo& info);
+        static void SetPumpRate(const Napi::CallbackInfo& info);
+        static Napi::Object NewInstance(Napi::Env env, const std::initializer_list<napi_value>& args = {});
+        // Add a new gamepad object to the registry and give it an id
+        static Napi::Object Register(Napi::Object gamepad);
         Gamepad(const Napi::CallbackInfo& info);
         ~Gamepad();
+        Napi::Value GetId(const Napi::CallbackInfo& info);
         Napi::Value IsActive(const Napi::CallbackInfo& info);
         void Destroy(const Napi::CallbackInfo& info);
         void ButtonDown(const Napi::CallbackInfo& info);
         void ButtonUp(const Napi::CallbackInfo& info);
         void SetAxis(const Napi::CallbackInfo& info);
+        void SetState(const Napi::CallbackInfo& info);
+        Napi::Value ShareState(const Napi::CallbackInfo& info);
+        void SetAxisResponse(const Napi::CallbackInfo& info);
+        void StartRecording(const Napi::CallbackInfo& info);
+        Napi::Value StopRecording(const Napi::CallbackInfo& info);
+        Napi::Value Replay(const Napi::CallbackInfo& info);
+        void On(const Napi::CallbackInfo& info);
+
+        #if defined(IS_LINUX)
+            // Build the uinput event for a button or axis, false if it has no mapping
+            bool ButtonCommand(int btnIndex, bool pressed, InjectCommand& command);
+            bool AxisCommand(int axisIndex, double axisValue, InjectCommand& command);
+
+            // Record a submitted button or axis command, so setState only sends the changes
+            void StoreState(const InjectCommand& command);
+
+            // Take the state back from a finished replay, false if the gamepad dropped it before
+            bool EndReplay(const GamepadReplay* replay, const GamepadState& state);
+        #endif
     private:
         bool m_active = false;
+        uint32_t m_id = 0;  // registry id, 0 after destroy
+        uint32_t m_buttonMask = 0;  // pressed buttons, for the trigger buttons of setState
+        GamepadResponse* m_response = nullptr;
         #if defined(IS_WINDOWS)
             PVIGEM_CLIENT m_client = nullptr;
             PVIGEM_TARGET m_pad = nullptr;
@@ -73,7 +170,15 @@ class Gamepad : public Napi::ObjectWrap<Gamepad> {
 
         #elif defined(IS_LINUX)
             UINPUT_FD m_uinput_fd = -1;
+            uint32_t m_device_id = 0;   // gamepad service id of the device
             GamepadState* m_state = nullptr;
+
+            // Set while the pump thread owns m_state
+            Napi::ObjectReference m_shared;
+            GamepadSharedState* m_sharedState = nullptr;
+
+            bool m_isRecording = false;
+            GamepadReplay* m_replay = nullptr;  // set while a replay thread writes the device
         #endif
 };
 
@@ -0,0 +1,554 @@
+#include "injector.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(IS_LINUX)
+    #include <string.h>
+    #include <unistd.h>
+    #include <linux/input.h>
+    #include <X11/Xlib.h>
+    #include <X11/extensions/XTest.h>
+    #include "display.h"
+    #include "gamepad.h"
+    #include "keyboard.h"
+    #include "mouse.h"
+    #include "uinput.h"
+#endif
+
+
+// Lock-free single producer single consumer ring buffer
+// The producer is the JS thread, the consumer is the injection thread
+template<typename T, size_t N>
+class SpscRing {
+    static_assert((N & (N - 1)) == 0, "Ring size must be a power of 2");
+
+    public:
+        bool Push(const T& item) {
+            size_t head = m_head.load(std::memory_order_relaxed);
+            if (head - m_tail.load(std::memory_order_acquire) == N) {
+                return false;
+            }
+            m_items[head & (N - 1)] = item;
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool Pop(T& item) {
+            size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (m_head.load(std::memory_order_acquire) == tail) {
+                return false;
+            }
+            item = m_items[tail & (N - 1)];
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool Empty() const {
+            return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+        }
+
+    private:
+        alignas(64) std::atomic<size_t> m_head{0};
+        alignas(64) std::atomic<size_t> m_tail{0};
+        alignas(64) T m_items[N];
+};
+
+
+// Injection thread state
+static SpscRing<InjectCommand, 4096> injectQueue;
+static std::thread injectThread;
+static std::atomic<bool> injectRunning{false};
+static std::atomic<bool> injectStop{false};
+
+// Wake up for the sleeping consumer
+static std::mutex injectWakeMutex;
+static std::condition_variable injectWakeCv;
+static std::atomic<bool> injectSleeping{false};
+
+// Progress tracking for flush()
+static uint64_t injectSubmitted = 0;  // only touched by the JS thread
+static std::atomic<uint64_t> injectExecuted{0};
+static std::mutex injectDoneMutex;
+static std::condition_variable injectDoneCv;
+
+// Set when X11 requests were issued since the last flush, uinput writes need no flush
+static bool injectXPending = false;
+
+#if defined(IS_LINUX)
+    // Events of the uinput frame under construction, only touched by the executing thread
+    static struct input_event injectFrame[UINPUT_MAX_FRAME];
+    static size_t injectFrameCount = 0;
+    static int injectFrameFd = -1;
+
+    static bool InjectFrameFlush() {
+        if (injectFrameCount == 0) {
+            return true;
+        }
+        bool isWritten = UinputWriteFrame(injectFrameFd, injectFrame, injectFrameCount);
+        injectFrameCount = 0;
+        return isWritten;
+    }
+
+    static void InjectFrameAppend(int fd, const struct input_event& event) {
+        // Another device or a full buffer closes the pending frame early
+        if (injectFrameCount > 0 && (injectFrameFd != fd || injectFrameCount == UINPUT_MAX_FRAME)) {
+            InjectFrameFlush();
+        }
+        injectFrameFd = fd;
+        injectFrame[injectFrameCount++] = event;
+    }
+
+    // Append the events and write the whole frame with one SYN_REPORT
+    static bool InjectFrameEnd(int fd, const struct input_event* events, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            InjectFrameAppend(fd, events[i]);
+        }
+        return InjectFrameFlush();
+    }
+#endif
+
+
+static void InjectLoop() {
+    InjectCommand command;
+    uint64_t executed = injectExecuted.load();
+
+    while (true) {
+        // Execute everything queued so far, then flush once
+        bool any = false;
+        while (injectQueue.Pop(command)) {
+            Injector::Execute(command);
+            executed++;
+            any = true;
+        }
+        if (any) {
+            #if defined(IS_LINUX)
+                if (injectXPending) {
+                    injectXPending = false;
+                    Display* display = XGetMainDisplay();
+                    if (display != nullptr) {
+                        XFlush(display);
+                    }
+                }
+            #endif
+            {
+                std::lock_guard<std::mutex> lock(injectDoneMutex);
+                injectExecuted.store(executed);
+            }
+            injectDoneCv.notify_all();
+        }
+
+        // Sleep until the producer pushes again
+        std::unique_lock<std::mutex> lock(injectWakeMutex);
+        injectSleeping.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        injectWakeCv.wait(lock, []() {
+            return !injectQueue.Empty() || injectStop.load();
+        });
+        injectSleeping.store(false);
+        if (injectStop.load() && injectQueue.Empty()) {
+            break;
+        }
+    }
+}
+
+static void InjectStart() {
+    if (injectRunning.load()) {
+        return;
+    }
+    injectStop.store(false);
+    injectRunning.store(true);
+    injectThread = std::thread(InjectLoop);
+}
+
+static void InjectStop() {
+    if (!injectRunning.load()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(injectWakeMutex);
+        injectStop.store(true);
+    }
+    injectWakeCv.notify_one();
+    injectThread.join();
+    injectRunning.store(false);
+
+    // Release pending flush() workers
+    {
+        std::lock_guard<std::mutex> lock(injectDoneMutex);
+    }
+    injectDoneCv.notify_all();
+}
+
+
+bool Injector::IsAsync() {
+    return injectRunning.load();
+}
+
+bool Injector::Execute(const InjectCommand& command) {
+    #if defined(IS_LINUX)
+        switch (command.op) {
+            case INJECT_UINPUT_EVENT:
+            case INJECT_UINPUT_EVENT_CONT: {
+                struct input_event ev;
+                memset(&ev, 0, sizeof(ev));
+                ev.type = command.b;
+                ev.code = command.c;
+                ev.value = command.d;
+                if (command.op == INJECT_UINPUT_EVENT_CONT) {
+                    InjectFrameAppend(command.a, ev);
+                    return true;
+                }
+                return InjectFrameEnd(command.a, &ev, 1);
+            }
+            case INJECT_UINPUT_ABS_XY:
+            case INJECT_UINPUT_REL_XY: {
+                // Both axes in one frame, so the pointer never stops at an intermediate position
+                bool isAbs = command.op == INJECT_UINPUT_ABS_XY;
+                struct input_event ev[2];
+                memset(ev, 0, sizeof(ev));
+                ev[0].type = isAbs ? EV_ABS : EV_REL;
+                ev[0].code = isAbs ? ABS_X : REL_X;
+                ev[0].value = command.b;
+                ev[1].type = isAbs ? EV_ABS : EV_REL;
+                ev[1].code = isAbs ? ABS_Y : REL_Y;
+                ev[1].value = command.c;
+                return InjectFrameEnd(command.a, ev, 2);
+            }
+            default:
+                break;
+        }
+
+        Display* display = XGetMainDisplay();
+        if (display == nullptr) {
+            return false;
+        }
+        injectXPending = true;
+
+        switch (command.op) {
+            case INJECT_MOUSE_SET_X:
+            case INJECT_MOUSE_SET_Y: {
+                Window root = DefaultRootWindow(display);
+                Window window_returned;
+                int root_x, root_y;
+                int win_x, win_y;
+                unsigned int mask_return;
+
+                // Get current position to keep the other coordinate
+                XQueryPointer(display, root, &window_returned,
+                    &window_returned, &root_x, &root_y,
+                    &win_x, &win_y, &mask_return);
+
+                if (command.op == INJECT_MOUSE_SET_X) {
+                    XWarpPointer(display, None, root, 0, 0, 0, 0, command.a, root_y);
+                } else {
+                    XWarpPointer(display, None, root, 0, 0, 0, 0, root_x, command.a);
+                }
+                return true;
+            }
+            case INJECT_MOUSE_MOVE:
+                XWarpPointer(display, None, DefaultRootWindow(display), 0, 0, 0, 0, command.a, command.b);
+                return true;
+            case INJECT_MOUSE_MOVE_BY:
+                // No source and destination window moves relative to the current position
+                XWarpPointer(display, None, None, 0, 0, 0, 0, command.a, command.b);
+                return true;
+            case INJECT_MOUSE_BUTTON:
+                XTestFakeButtonEvent(display, command.a, command.b ? True : False, CurrentTime);
+                return true;
+            case INJECT_MOUSE_SCROLL:
+                // Simulate multiple scroll events based on amount
+                for (int i = 0; i < command.b; i++) {
+                    XTestFakeButtonEvent(display, command.a, True, CurrentTime);
+                    XTestFakeButtonEvent(display, command.a, False, CurrentTime);
+                }
+                return true;
+            case INJECT_KEY:
+                XTestFakeKeyEvent(display, command.a, command.b ? True : False, 0);
+                return true;
+            case INJECT_KEY_BIND: {
+                KeySym keysyms[2] = {(KeySym)command.b, (KeySym)command.b};
+                XChangeKeyboardMapping(display, command.a, 2, keysyms, 1);
+                return true;
+            }
+            case INJECT_X_SYNC:
+                XSync(display, False);
+                usleep(command.a);
+                return true;
+            default:
+                return false;
+        }
+    #else
+        return false;
+    #endif
+}
+
+bool Injector::Submit(const InjectCommand& command) {
+    if (!injectRunning.load()) {
+        return Injector::Execute(command);
+    }
+
+    // Wait for free space if the injection thread fell behind
+    while (!injectQueue.Push(command)) {
+        injectWakeCv.notify_one();
+        std::this_thread::yield();
+    }
+    injectSubmitted++;
+
+    // Wake up the consumer if it went to sleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (injectSleeping.load()) {
+        std::lock_guard<std::mutex> lock(injectWakeMutex);
+        injectWakeCv.notify_one();
+    }
+    return true;
+}
+
+void Injector::Commit() {
+    if (injectRunning.load()) {
+        return;
+    }
+    #if defined(IS_LINUX)
+        if (!injectXPending) {
+            return;
+        }
+        injectXPending = false;
+        Display* display = XGetMainDisplay();
+        if (display != nullptr) {
+            XFlush(display);
+        }
+    #endif
+}
+
+void Injector::WaitFor(uint64_t target) {
+    std::unique_lock<std::mutex> lock(injectDoneMutex);
+    injectDoneCv.wait(lock, [target]() {
+        return injectExecuted.load() >= target || !injectRunning.load();
+    });
+}
+
+void Injector::Drain() {
+    if (injectRunning.load()) {
+        Injector::WaitFor(injectSubmitted);
+    }
+}
+
+
+// Flush async implementation
+FlushWorker::FlushWorker(const Napi::Env& env, uint64_t target) : Napi::AsyncWorker{env, "FlushWorker"}, m_deferred{env}, m_target{target} {}
+
+Napi::Promise FlushWorker::GetPromise() {
+    return m_deferred.Promise();
+}
+
+void FlushWorker::Execute() {
+    Injector::WaitFor(this->m_target);
+}
+
+void FlushWorker::OnOK() {
+    m_deferred.Resolve(Env().Undefined());
+}
+
+void FlushWorker::OnError(const Napi::Error& err) {
+    m_deferred.Reject(err.Value());
+}
+
+
+void Injector::setAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1) {
+        Napi::TypeError::New(env, "Expected 1 argument").ThrowAsJavaScriptException();
+        return;
+    }
+
+    if (!info[0].IsBoolean()) {
+        Napi::TypeError::New(env, "Expected boolean argument").ThrowAsJavaScriptException();
+        return;
+    }
+
+    bool enabled = info[0].As<Napi::Boolean>().Value();
+
+    #if defined(IS_LINUX)
+        if (enabled) {
+            InjectStart();
+        } else {
+            InjectStop();
+        }
+    #else
+        if (enabled) {
+            Napi::Error::New(env, "Asynchronous mode is not supported on this platform").ThrowAsJavaScriptException();
+            return;
+        }
+    #endif
+}
+
+Napi::Boolean Injector::isAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    return Napi::Boolean::New(env, Injector::IsAsync());
+}
+
+Napi::Promise Injector::flush(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    FlushWorker* worker = new FlushWorker(env, injectSubmitted);
+    Napi::Promise promise = worker->GetPromise();
+    worker->Queue();
+    return promise;
+}
+
+
+Napi::Value Injector::sendBatch(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1) {
+        Napi::TypeError::New(env, "Expected 1 argument").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    const int32_t* words = nullptr;
+    size_t count = 0;
+    if (info[0].IsArrayBuffer()) {
+        Napi::ArrayBuffer buffer = info[0].As<Napi::ArrayBuffer>();
+        if (buffer.ByteLength() % sizeof(int32_t) != 0) {
+            Napi::RangeError::New(env, "Batch length must be a multiple of 4 bytes").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        words = (const int32_t*)buffer.Data();
+        count = buffer.ByteLength() / sizeof(int32_t);
+    } else if (info[0].IsTypedArray() && info[0].As<Napi::TypedArray>().TypedArrayType() == napi_int32_array) {
+        Napi::Int32Array array = info[0].As<Napi::Int32Array>();
+        words = array.Data();
+        count = array.ElementLength();
+    } else {
+        Napi::TypeError::New(env, "Expected ArrayBuffer or Int32Array argument").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Array gamepadArr;
+    if (info.Length() > 1 && !info[1].IsUndefined()) {
+        if (!info[1].IsArray()) {
+            Napi::TypeError::New(env, "Expected array of gamepads in 2nd argument").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        gamepadArr = info[1].As<Napi::Array>();
+    }
+
+    #if defined(IS_LINUX)
+        // Translate every record before anything is injected
+        std::vector<InjectCommand> commands;
+        std::vector<Gamepad*> owners;
+        commands.reserve(count / 3);
+        owners.reserve(count / 3);
+
+        size_t i = 0;
+        while (i < count) {
+            int32_t op = words[i];
+            size_t argc = 0;
+            switch (op) {
+                case BATCH_MOVE: argc = 2; break;
+                case BATCH_BUTTON: argc = 2; break;
+                case BATCH_SCROLL: argc = 2; break;
+                case BATCH_KEY: argc = 2; break;
+                case BATCH_GAMEPAD_AXIS: argc = 3; break;
+                case BATCH_GAMEPAD_BUTTON: argc = 3; break;
+                default:
+                    Napi::RangeError::New(env, "Unknown batch opcode at word " + std::to_string(i)).ThrowAsJavaScriptException();
+                    return env.Undefined();
+            }
+            if (i + 1 + argc > count) {
+                Napi::RangeError::New(env, "Truncated batch record at word " + std::to_string(i)).ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+            const int32_t* args = words + i + 1;
+
+            InjectCommand command = {INJECT_NONE, 0, 0, 0, 0};
+            Gamepad* owner = nullptr;
+            switch (op) {
+                case BATCH_MOVE:
+                    command = Mouse::MoveCommand(args[0], args[1]);
+                    break;
+                case BATCH_BUTTON:
+                    if (args[0] < 0 || args[0] > 4) {
+                        Napi::RangeError::New(env, "Invalid mouse button at word " + std::to_string(i)).ThrowAsJavaScriptException();
+                        return env.Undefined();
+                    }
+                    command = Mouse::ButtonCommand(args[0], args[1] != 0);
+                    break;
+                case BATCH_SCROLL:
+                    command = Mouse::ScrollCommand(args[0], args[1] != 0);
+                    break;
+                case BATCH_KEY:
+                    // X11 keycodes are the evdev codes shifted by 8
+                    if (args[0] <= 0 || args[0] > 247) {
+                        Napi::RangeError::New(env, "Invalid key code at word " + std::to_string(i)).ThrowAsJavaScriptException();
+                        return env.Undefined();
+                    }
+                    command = Keyboard::KeyCommand(args[0], args[1] != 0, true);
+                    break;
+                case BATCH_GAMEPAD_AXIS:
+                case BATCH_GAMEPAD_BUTTON: {
+                    if (gamepadArr.IsEmpty() || args[0] < 0 || (uint32_t)args[0] >= gamepadArr.Length() ||
+                        !gamepadArr.Get((uint32_t)args[0]).IsObject()) {
+                        Napi::RangeError::New(env, "Invalid gamepad index at word " + std::to_string(i)).ThrowAsJavaScriptException();
+                        return env.Undefined();
+                    }
+                    Gamepad* gamepad = Gamepad::Unwrap(gamepadArr.Get((uint32_t)args[0]).As<Napi::Object>());
+                    if (gamepad == nullptr) {
+                        return env.Undefined();
+                    }
+                    bool isValid;
+                    if (op == BATCH_GAMEPAD_AXIS) {
+                        isValid = args[2] >= -32767 && args[2] <= 32767 &&
+                            gamepad->AxisCommand(args[1], args[2] / 32767.0, command);
+                    } else {
+                        isValid = gamepad->ButtonCommand(args[1], args[2] != 0, command);
+                    }
+                    if (!isValid) {
+                        Napi::RangeError::New(env, "Invalid gamepad record at word " + std::to_string(i)).ThrowAsJavaScriptException();
+                        return env.Undefined();
+                    }
+                    owner = gamepad;
+                    break;
+                }
+            }
+            commands.push_back(command);
+            owners.push_back(owner);
+            i += 1 + argc;
+        }
+
+        // Inject everything with a single flush at the end
+        for (size_t j = 0; j < commands.size(); j++) {
+            if (!Injector::Submit(commands[j])) {
+                Injector::Commit();
+                Napi::Error::New(env, "Failed to send batch record " + std::to_string(j)).ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+            if (owners[j] != nullptr) {
+                owners[j]->StoreState(commands[j]);
+            }
+        }
+        Injector::Commit();
+
+        return Napi::Number::New(env, (double)commands.size());
+    #else
+        Napi::Error::New(env, "Batch input is not supported on this platform").ThrowAsJavaScriptException();
+        return env.Undefined();
+    #endif
+}
+
+
+Napi::Object Injector::Init(Napi::Env env, Napi::Object exports) {
+    exports.Set(Napi::String::New(env, "setAsync"), Napi::Function::New(env, Injector::setAsync));
+    exports.Set(Napi::String::New(env, "isAsync"), Napi::Function::New(env, Injector::isAsync));
+    exports.Set(Napi::String::New(env, "flush"), Napi::Function::New(env, Injector::flush));
+    exports.Set(Napi::String::New(env, "sendBatch"), Napi::Function::New(env, Injector::sendBatch));
+
+    // Join the injection thread before the environment goes away
+    napi_add_env_cleanup_hook(env, [](void* arg) {
+        InjectStop();
+    }, nullptr);
+
+    return exports;
+}
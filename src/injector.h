@@ -0,0 +1,85 @@
+#pragma once
+#ifndef INJECTOR_H
+#define INJECTOR_H
+
+#include <napi.h>
+#include <stdint.h>
+
+// Input operations executed by the injector
+enum InjectOp : int32_t {
+    INJECT_NONE = 0,
+    INJECT_MOUSE_SET_X = 1,     // a: x
+    INJECT_MOUSE_SET_Y = 2,     // a: y
+    INJECT_MOUSE_BUTTON = 3,    // a: X11 button, b: 1 press / 0 release
+    INJECT_MOUSE_SCROLL = 4,    // a: X11 wheel button, b: click count
+    INJECT_KEY = 5,             // a: X11 keycode, b: 1 press / 0 release
+    INJECT_UINPUT_EVENT = 6,    // a: uinput fd, b: event type, c: event code, d: event value
+    INJECT_MOUSE_MOVE = 7,      // a: x, b: y
+    INJECT_MOUSE_MOVE_BY = 8,   // a: dx, b: dy
+    INJECT_UINPUT_ABS_XY = 9,   // a: uinput fd, b: ABS_X value, c: ABS_Y value
+    INJECT_UINPUT_REL_XY = 10,  // a: uinput fd, b: REL_X value, c: REL_Y value
+    INJECT_UINPUT_EVENT_CONT = 11,  // same as INJECT_UINPUT_EVENT, the next uinput command on the fd completes the frame
+    INJECT_KEY_BIND = 12,       // a: X11 keycode, b: keysym bound to every level (NoSymbol unbinds)
+    INJECT_X_SYNC = 13          // a: microseconds to wait after the X server processed every request
+};
+
+// Control.sendBatch() wire format
+// The batch is a flat array of native-endian int32 words. Each record is an
+// opcode word followed by the fixed number of argument words listed below.
+enum BatchOp : int32_t {
+    BATCH_MOVE = 1,             // x, y
+    BATCH_BUTTON = 2,           // button (0 left, 1 middle, 2 right, 3 back, 4 forward), pressed (1/0)
+    BATCH_SCROLL = 3,           // amount (positive down/right, negative up/left), horizontal (1/0)
+    BATCH_KEY = 4,              // Linux KEY_* code (linux/input-event-codes.h), pressed (1/0)
+    BATCH_GAMEPAD_AXIS = 5,     // gamepad index, axis, value (-32767 to 32767 maps to -1.0 to 1.0)
+    BATCH_GAMEPAD_BUTTON = 6    // gamepad index, button, pressed (1/0)
+};
+
+// Compact command stored in the injection queue
+struct InjectCommand {
+    int32_t op;
+    int32_t a;
+    int32_t b;
+    int32_t c;
+    int32_t d;
+};
+
+class FlushWorker : public Napi::AsyncWorker {
+    public:
+        FlushWorker(const Napi::Env& env, uint64_t target);
+        Napi::Promise GetPromise();
+
+    protected:
+        void Execute();
+        void OnOK();
+        void OnError(const Napi::Error& e);
+
+    private:
+        Napi::Promise::Deferred m_deferred;
+        uint64_t m_target;
+};
+
+class Injector {
+    public:
+        static Napi::Object Init(Napi::Env env, Napi::Object exports);
+        static void setAsync(const Napi::CallbackInfo& info);
+        static Napi::Boolean isAsync(const Napi::CallbackInfo& info);
+        static Napi::Promise flush(const Napi::CallbackInfo& info);
+        static Napi::Value sendBatch(const Napi::CallbackInfo& info);
+
+        // Execute the command now, or queue it for the injection thread in async mode
+        // Returns false if a synchronously executed command failed
+        static bool Submit(const InjectCommand& command);
+
+        // Push pending synchronous X11 requests to the server (no-op in async mode or without X11 input)
+        static void Commit();
+
+        // Block until every queued command was executed
+        static void Drain();
+
+        static bool IsAsync();
+        static bool Execute(const InjectCommand& command);
+        static void WaitFor(uint64_t target);
+};
+
+#endif
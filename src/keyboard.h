@@ -4,17 +4,31 @@
 
 #include <napi.h>
 
+#if defined(IS_LINUX)
+    #include "injector.h"
+#endif
+
 class Keyboard {
     public:
         static Napi::Object Init(Napi::Env env, Napi::Object exports);
         static void keyDown(const Napi::CallbackInfo& info);
         static void keyUp(const Napi::CallbackInfo& info);
         static Napi::Boolean isKeySupported(const Napi::CallbackInfo& info);
+        static void sendChord(const Napi::CallbackInfo& info);
         
         static void type(const Napi::CallbackInfo& info);
 
         static Napi::String GetLayout(const Napi::CallbackInfo& info);
         static void SetLayout(const Napi::CallbackInfo& info);
+
+        static void setBackend(const Napi::CallbackInfo& info);
+        static Napi::String getBackend(const Napi::CallbackInfo& info);
+
+        #if defined(IS_LINUX)
+            // Build the command for the selected backend from a Linux KEY_* code
+            // isFrameEnd false keeps the uinput frame open for the next key of a chord
+            static InjectCommand KeyCommand(int keyCode, bool pressed, bool isFrameEnd);
+        #endif
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,829 @@
+// Generated by dev/keycodes.js, do not edit
+#pragma once
+#ifndef KEYCODES_H
+#define KEYCODES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(IS_LINUX)
+    #include <linux/input-event-codes.h>
+#elif defined(IS_MACOS)
+    #include <Carbon/Carbon.h>
+#endif
+
+// KeyboardEvent.code name and its numeric code, the numeric code is the Linux KEY_* value
+struct KeyName {
+    const char* name;
+    uint8_t length;
+    uint16_t code;
+};
+
+constexpr int KEY_CODE_LIMIT = 512;
+
+#if defined(IS_LINUX)
+    constexpr uint32_t KEY_HASH_SIZE = 256;
+
+    constexpr KeyName KEY_NAMES[] = {
+        {"Escape", 6, 1},
+        {"Digit1", 6, 2},
+        {"Digit2", 6, 3},
+        {"Digit3", 6, 4},
+        {"Digit4", 6, 5},
+        {"Digit5", 6, 6},
+        {"Digit6", 6, 7},
+        {"Digit7", 6, 8},
+        {"Digit8", 6, 9},
+        {"Digit9", 6, 10},
+        {"Digit0", 6, 11},
+        {"Minus", 5, 12},
+        {"Equal", 5, 13},
+        {"Backspace", 9, 14},
+        {"Tab", 3, 15},
+        {"KeyQ", 4, 16},
+        {"KeyW", 4, 17},
+        {"KeyE", 4, 18},
+        {"KeyR", 4, 19},
+        {"KeyT", 4, 20},
+        {"KeyY", 4, 21},
+        {"KeyU", 4, 22},
+        {"KeyI", 4, 23},
+        {"KeyO", 4, 24},
+        {"KeyP", 4, 25},
+        {"BracketLeft", 11, 26},
+        {"BracketRight", 12, 27},
+        {"Enter", 5, 28},
+        {"ControlLeft", 11, 29},
+        {"KeyA", 4, 30},
+        {"KeyS", 4, 31},
+        {"KeyD", 4, 32},
+        {"KeyF", 4, 33},
+        {"KeyG", 4, 34},
+        {"KeyH", 4, 35},
+        {"KeyJ", 4, 36},
+        {"KeyK", 4, 37},
+        {"KeyL", 4, 38},
+        {"Semicolon", 9, 39},
+        {"Quote", 5, 40},
+        {"Backquote", 9, 41},
+        {"ShiftLeft", 9, 42},
+        {"Backslash", 9, 43},
+        {"KeyZ", 4, 44},
+        {"KeyX", 4, 45},
+        {"KeyC", 4, 46},
+        {"KeyV", 4, 47},
+        {"KeyB", 4, 48},
+        {"KeyN", 4, 49},
+        {"KeyM", 4, 50},
+        {"Comma", 5, 51},
+        {"Period", 6, 52},
+        {"Slash", 5, 53},
+        {"ShiftRight", 10, 54},
+        {"NumpadMultiply", 14, 55},
+        {"AltLeft", 7, 56},
+        {"Space", 5, 57},
+        {"CapsLock", 8, 58},
+        {"F1", 2, 59},
+        {"F2", 2, 60},
+        {"F3", 2, 61},
+        {"F4", 2, 62},
+        {"F5", 2, 63},
+        {"F6", 2, 64},
+        {"F7", 2, 65},
+        {"F8", 2, 66},
+        {"F9", 2, 67},
+        {"F10", 3, 68},
+        {"NumLock", 7, 69},
+        {"ScrollLock", 10, 70},
+        {"Numpad7", 7, 71},
+        {"Numpad8", 7, 72},
+        {"Numpad9", 7, 73},
+        {"NumpadSubtract", 14, 74},
+        {"Numpad4", 7, 75},
+        {"Numpad5", 7, 76},
+        {"Numpad6", 7, 77},
+        {"NumpadAdd", 9, 78},
+        {"Numpad1", 7, 79},
+        {"Numpad2", 7, 80},
+        {"Numpad3", 7, 81},
+        {"Numpad0", 7, 82},
+        {"NumpadDecimal", 13, 83},
+        {"Lang5", 5, 85},
+        {"IntlBackslash", 13, 86},
+        {"F11", 3, 87},
+        {"F12", 3, 88},
+        {"IntlRo", 6, 89},
+        {"Lang3", 5, 90},
+        {"Lang4", 5, 91},
+        {"Convert", 7, 92},
+        {"KanaMode", 8, 93},
+        {"NonConvert", 10, 94},
+        {"NumpadEnter", 11, 96},
+        {"ControlRight", 12, 97},
+        {"NumpadDivide", 12, 98},
+        {"PrintScreen", 11, 99},
+        {"AltRight", 8, 100},
+        {"Home", 4, 102},
+        {"ArrowUp", 7, 103},
+        {"PageUp", 6, 104},
+        {"ArrowLeft", 9, 105},
+        {"ArrowRight", 10, 106},
+        {"End", 3, 107},
+        {"ArrowDown", 9, 108},
+        {"PageDown", 8, 109},
+        {"Insert", 6, 110},
+        {"Delete", 6, 111},
+        {"VolumeMute", 10, 113},
+        {"AudioVolumeMute", 15, 113},
+        {"VolumeDown", 10, 114},
+        {"AudioVolumeDown", 15, 114},
+        {"VolumeUp", 8, 115},
+        {"AudioVolumeUp", 13, 115},
+        {"Power", 5, 116},
+        {"NumpadEqual", 11, 117},
+        {"Pause", 5, 119},
+        {"NumpadComma", 11, 121},
+        {"Lang1", 5, 122},
+        {"Lang2", 5, 123},
+        {"IntlYen", 7, 124},
+        {"MetaLeft", 8, 125},
+        {"OSLeft", 6, 125},
+        {"MetaRight", 9, 126},
+        {"OSRight", 7, 126},
+        {"ContextMenu", 11, 127},
+        {"BrowserStop", 11, 128},
+        {"Abort", 5, 128},
+        {"Again", 5, 129},
+        {"Props", 5, 130},
+        {"Undo", 4, 131},
+        {"Select", 6, 132},
+        {"Copy", 4, 133},
+        {"Open", 4, 134},
+        {"Paste", 5, 135},
+        {"Find", 4, 136},
+        {"Cut", 3, 137},
+        {"Help", 4, 138},
+        {"LaunchApp2", 10, 140},
+        {"Sleep", 5, 142},
+        {"WakeUp", 6, 143},
+        {"LaunchApp1", 10, 144},
+        {"LaunchMail", 10, 155},
+        {"BrowserFavorites", 16, 156},
+        {"BrowserBack", 11, 158},
+        {"BrowserForward", 14, 159},
+        {"Eject", 5, 161},
+        {"MediaTrackNext", 14, 163},
+        {"MediaPlayPause", 14, 164},
+        {"MediaTrackPrevious", 18, 165},
+        {"MediaStop", 9, 166},
+        {"MediaSelect", 11, 171},
+        {"BrowserHome", 11, 172},
+        {"BrowserRefresh", 14, 173},
+        {"NumpadParenLeft", 15, 179},
+        {"NumpadParenRight", 16, 180},
+        {"F13", 3, 183},
+        {"F14", 3, 184},
+        {"F15", 3, 185},
+        {"F16", 3, 186},
+        {"F17", 3, 187},
+        {"F18", 3, 188},
+        {"F19", 3, 189},
+        {"F20", 3, 190},
+        {"F21", 3, 191},
+        {"F22", 3, 192},
+        {"F23", 3, 193},
+        {"F24", 3, 194},
+        {"BrowserSearch", 13, 217}
+    };
+
+    constexpr int16_t KEY_DISPLACE[KEY_HASH_SIZE] = {
+        -256, 0, 0, -253, 0, 0, -252, 0, 0, 0, 1, -251, 1, 0, 0, 0,
+        0, -249, 0, 0, -247, 0, -245, -242, 1, 0, -241, -240, -238, 0, 0, -236,
+        -235, 0, 0, 0, -233, -232, -231, 0, 0, 0, -230, -228, 0, -227, 1, 1,
+        0, -224, 1, 0, 0, 0, 0, -223, 0, 0, 0, 0, 1, 0, 0, -222,
+        -220, -219, 0, 0, 0, -218, -217, 0, 1, 0, 1, -214, 0, 1, 0, -213,
+        0, -212, 0, 1, -209, 0, 0, -208, -206, 0, 0, 0, 0, 1, 0, 0,
+        0, 0, 1, -205, 1, 0, -203, 1, 0, 0, -200, 0, -199, -198, 0, 0,
+        0, -195, 0, 3, 0, 0, 0, 1, -194, -193, -192, -191, -190, -189, 2, 0,
+        0, 0, 0, -188, 0, 0, 0, 0, 1, 0, 1, -187, -186, -185, 0, -183,
+        0, 0, -181, 6, 0, 0, -180, 1, -179, 1, 0, -176, 0, -175, -174, 3,
+        0, 0, 0, 0, 0, 0, -173, 0, -171, -168, 0, -167, 0, -165, 3, 0,
+        0, 0, -164, 2, -163, 0, 0, 0, 0, -162, 0, 0, -161, 0, 1, 0,
+        1, 0, 0, -160, -159, 2, -157, 0, 0, 0, 1, 0, -156, 0, 0, 1,
+        0, -155, 0, -152, 3, 0, 0, -151, -150, -149, -147, 0, -146, -145, 0, 0,
+        -142, 0, 0, -140, -139, 0, 1, -138, 0, 1, -137, -136, -135, 0, 0, -134,
+        -133, 0, 2, 0, 0, 1, 0, 0, 0, -132, -131, 0, -129, 0, 0, 2
+    };
+
+    constexpr int16_t KEY_SLOTS[KEY_HASH_SIZE] = {
+        45, 151, 57, -1, 40, -1, -1, 134, -1, 140, 49, -1, -1, -1, -1, 36,
+        72, -1, -1, -1, -1, -1, -1, -1, -1, 123, -1, 152, 131, -1, -1, -1,
+        155, -1, -1, -1, 133, 65, -1, 144, -1, -1, -1, 35, -1, -1, -1, -1,
+        -1, 41, -1, -1, -1, 19, -1, -1, -1, -1, -1, 81, -1, -1, 127, -1,
+        -1, 147, -1, 64, 87, 167, -1, -1, -1, 98, -1, -1, -1, -1, -1, -1,
+        -1, 34, 130, -1, -1, -1, 15, -1, -1, 25, -1, 43, -1, -1, -1, -1,
+        -1, 79, -1, 122, 89, -1, -1, -1, -1, -1, -1, -1, 117, 114, 162, 119,
+        -1, -1, -1, -1, -1, 104, -1, 48, 125, -1, -1, -1, -1, -1, -1, -1,
+        68, 44, 18, 5, 74, 128, 14, 17, 159, 91, 62, 101, 121, 161, 55, 60,
+        9, 115, 112, 47, 165, 73, 26, 7, 142, 103, 154, 13, 108, 37, 157, 69,
+        54, 148, 141, 10, 27, 71, 100, 70, 78, 38, 139, 118, 113, 86, 63, 110,
+        120, 46, 58, 146, 153, 124, 12, 50, 30, 2, 92, 75, 160, 145, 99, 135,
+        23, 67, 129, 90, 126, 138, 102, 107, 32, 93, 4, 105, 136, 31, 80, 158,
+        94, 88, 149, 59, 11, 28, 61, 24, 166, 1, 16, 6, 22, 77, 29, 156,
+        39, 106, 116, 150, 95, 109, 0, 56, 51, 132, 164, 3, 111, 96, 20, 21,
+        137, 42, 168, 8, 76, 84, 143, 83, 33, 163, 85, 97, 53, 52, 82, 66
+    };
+
+    constexpr int32_t KEY_NATIVE[KEY_CODE_LIMIT] = {
+        -1, KEY_ESC, KEY_1, KEY_2, KEY_3, KEY_4, KEY_5, KEY_6,
+        KEY_7, KEY_8, KEY_9, KEY_0, KEY_MINUS, KEY_EQUAL, KEY_BACKSPACE, KEY_TAB,
+        KEY_Q, KEY_W, KEY_E, KEY_R, KEY_T, KEY_Y, KEY_U, KEY_I,
+        KEY_O, KEY_P, KEY_LEFTBRACE, KEY_RIGHTBRACE, KEY_ENTER, KEY_LEFTCTRL, KEY_A, KEY_S,
+        KEY_D, KEY_F, KEY_G, KEY_H, KEY_J, KEY_K, KEY_L, KEY_SEMICOLON,
+        KEY_APOSTROPHE, KEY_GRAVE, KEY_LEFTSHIFT, KEY_BACKSLASH, KEY_Z, KEY_X, KEY_C, KEY_V,
+        KEY_B, KEY_N, KEY_M, KEY_COMMA, KEY_DOT, KEY_SLASH, KEY_RIGHTSHIFT, KEY_KPASTERISK,
+        KEY_LEFTALT, KEY_SPACE, KEY_CAPSLOCK, KEY_F1, KEY_F2, KEY_F3, KEY_F4, KEY_F5,
+        KEY_F6, KEY_F7, KEY_F8, KEY_F9, KEY_F10, KEY_NUMLOCK, KEY_SCROLLLOCK, KEY_KP7,
+        KEY_KP8, KEY_KP9, KEY_KPMINUS, KEY_KP4, KEY_KP5, KEY_KP6, KEY_KPPLUS, KEY_KP1,
+        KEY_KP2, KEY_KP3, KEY_KP0, KEY_KPDOT, -1, KEY_ZENKAKUHANKAKU, KEY_102ND, KEY_F11,
+        KEY_F12, KEY_RO, KEY_KATAKANA, KEY_HIRAGANA, KEY_HENKAN, KEY_KATAKANAHIRAGANA, KEY_MUHENKAN, -1,
+        KEY_KPENTER, KEY_RIGHTCTRL, KEY_KPSLASH, KEY_SYSRQ, KEY_RIGHTALT, -1, KEY_HOME, KEY_UP,
+        KEY_PAGEUP, KEY_LEFT, KEY_RIGHT, KEY_END, KEY_DOWN, KEY_PAGEDOWN, KEY_INSERT, KEY_DELETE,
+        -1, KEY_MUTE, KEY_VOLUMEDOWN, KEY_VOLUMEUP, KEY_POWER, KEY_KPEQUAL, -1, KEY_PAUSE,
+        -1, KEY_KPCOMMA, KEY_HANGEUL, KEY_HANJA, KEY_YEN, KEY_LEFTMETA, KEY_RIGHTMETA, KEY_COMPOSE,
+        KEY_STOP, KEY_AGAIN, KEY_PROPS, KEY_UNDO, KEY_FRONT, KEY_COPY, KEY_OPEN, KEY_PASTE,
+        KEY_FIND, KEY_CUT, KEY_HELP, -1, KEY_CALC, -1, KEY_SLEEP, KEY_WAKEUP,
+        KEY_FILE, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, KEY_MAIL, KEY_BOOKMARKS, -1, KEY_BACK, KEY_FORWARD,
+        -1, KEY_EJECTCD, -1, KEY_NEXTSONG, KEY_PLAYPAUSE, KEY_PREVIOUSSONG, KEY_STOPCD, -1,
+        -1, -1, -1, KEY_CONFIG, KEY_HOMEPAGE, KEY_REFRESH, -1, -1,
+        -1, -1, -1, KEY_KPLEFTPAREN, KEY_KPRIGHTPAREN, -1, -1, KEY_F13,
+        KEY_F14, KEY_F15, KEY_F16, KEY_F17, KEY_F18, KEY_F19, KEY_F20, KEY_F21,
+        KEY_F22, KEY_F23, KEY_F24, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, KEY_SEARCH, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1
+    };
+
+#elif defined(IS_WINDOWS)
+    constexpr uint32_t KEY_HASH_SIZE = 256;
+
+    constexpr KeyName KEY_NAMES[] = {
+        {"Escape", 6, 1},
+        {"Digit1", 6, 2},
+        {"Digit2", 6, 3},
+        {"Digit3", 6, 4},
+        {"Digit4", 6, 5},
+        {"Digit5", 6, 6},
+        {"Digit6", 6, 7},
+        {"Digit7", 6, 8},
+        {"Digit8", 6, 9},
+        {"Digit9", 6, 10},
+        {"Digit0", 6, 11},
+        {"Minus", 5, 12},
+        {"Equal", 5, 13},
+        {"Backspace", 9, 14},
+        {"Tab", 3, 15},
+        {"KeyQ", 4, 16},
+        {"KeyW", 4, 17},
+        {"KeyE", 4, 18},
+        {"KeyR", 4, 19},
+        {"KeyT", 4, 20},
+        {"KeyY", 4, 21},
+        {"KeyU", 4, 22},
+        {"KeyI", 4, 23},
+        {"KeyO", 4, 24},
+        {"KeyP", 4, 25},
+        {"BracketLeft", 11, 26},
+        {"BracketRight", 12, 27},
+        {"Enter", 5, 28},
+        {"ControlLeft", 11, 29},
+        {"KeyA", 4, 30},
+        {"KeyS", 4, 31},
+        {"KeyD", 4, 32},
+        {"KeyF", 4, 33},
+        {"KeyG", 4, 34},
+        {"KeyH", 4, 35},
+        {"KeyJ", 4, 36},
+        {"KeyK", 4, 37},
+        {"KeyL", 4, 38},
+        {"Semicolon", 9, 39},
+        {"Quote", 5, 40},
+        {"Backquote", 9, 41},
+        {"ShiftLeft", 9, 42},
+        {"Backslash", 9, 43},
+        {"KeyZ", 4, 44},
+        {"KeyX", 4, 45},
+        {"KeyC", 4, 46},
+        {"KeyV", 4, 47},
+        {"KeyB", 4, 48},
+        {"KeyN", 4, 49},
+        {"KeyM", 4, 50},
+        {"Comma", 5, 51},
+        {"Period", 6, 52},
+        {"Slash", 5, 53},
+        {"ShiftRight", 10, 54},
+        {"NumpadMultiply", 14, 55},
+        {"AltLeft", 7, 56},
+        {"Space", 5, 57},
+        {"CapsLock", 8, 58},
+        {"F1", 2, 59},
+        {"F2", 2, 60},
+        {"F3", 2, 61},
+        {"F4", 2, 62},
+        {"F5", 2, 63},
+        {"F6", 2, 64},
+        {"F7", 2, 65},
+        {"F8", 2, 66},
+        {"F9", 2, 67},
+        {"F10", 3, 68},
+        {"NumLock", 7, 69},
+        {"ScrollLock", 10, 70},
+        {"Numpad7", 7, 71},
+        {"Numpad8", 7, 72},
+        {"Numpad9", 7, 73},
+        {"NumpadSubtract", 14, 74},
+        {"Numpad4", 7, 75},
+        {"Numpad5", 7, 76},
+        {"Numpad6", 7, 77},
+        {"NumpadAdd", 9, 78},
+        {"Numpad1", 7, 79},
+        {"Numpad2", 7, 80},
+        {"Numpad3", 7, 81},
+        {"Numpad0", 7, 82},
+        {"NumpadDecimal", 13, 83},
+        {"IntlBackslash", 13, 86},
+        {"F11", 3, 87},
+        {"F12", 3, 88},
+        {"IntlRo", 6, 89},
+        {"Lang3", 5, 90},
+        {"Lang4", 5, 91},
+        {"Convert", 7, 92},
+        {"KanaMode", 8, 93},
+        {"NonConvert", 10, 94},
+        {"NumpadEnter", 11, 96},
+        {"ControlRight", 12, 97},
+        {"NumpadDivide", 12, 98},
+        {"PrintScreen", 11, 99},
+        {"AltRight", 8, 100},
+        {"Home", 4, 102},
+        {"ArrowUp", 7, 103},
+        {"PageUp", 6, 104},
+        {"ArrowLeft", 9, 105},
+        {"ArrowRight", 10, 106},
+        {"End", 3, 107},
+        {"ArrowDown", 9, 108},
+        {"PageDown", 8, 109},
+        {"Insert", 6, 110},
+        {"Delete", 6, 111},
+        {"AudioVolumeMute", 15, 113},
+        {"VolumeDown", 10, 114},
+        {"AudioVolumeDown", 15, 114},
+        {"VolumeUp", 8, 115},
+        {"AudioVolumeUp", 13, 115},
+        {"Power", 5, 116},
+        {"NumpadEqual", 11, 117},
+        {"Pause", 5, 119},
+        {"NumpadComma", 11, 121},
+        {"Lang1", 5, 122},
+        {"Lang2", 5, 123},
+        {"IntlYen", 7, 124},
+        {"MetaLeft", 8, 125},
+        {"OSLeft", 6, 125},
+        {"MetaRight", 9, 126},
+        {"OSRight", 7, 126},
+        {"ContextMenu", 11, 127},
+        {"BrowserStop", 11, 128},
+        {"Undo", 4, 131},
+        {"Copy", 4, 133},
+        {"Paste", 5, 135},
+        {"Cut", 3, 137},
+        {"Help", 4, 138},
+        {"LaunchApp2", 10, 140},
+        {"Sleep", 5, 142},
+        {"WakeUp", 6, 143},
+        {"LaunchApp1", 10, 144},
+        {"LaunchMail", 10, 155},
+        {"BrowserFavorites", 16, 156},
+        {"BrowserBack", 11, 158},
+        {"BrowserForward", 14, 159},
+        {"Eject", 5, 161},
+        {"MediaTrackNext", 14, 163},
+        {"MediaPlayPause", 14, 164},
+        {"MediaTrackPrevious", 18, 165},
+        {"MediaStop", 9, 166},
+        {"MediaSelect", 11, 171},
+        {"BrowserHome", 11, 172},
+        {"BrowserRefresh", 14, 173},
+        {"F13", 3, 183},
+        {"F14", 3, 184},
+        {"F15", 3, 185},
+        {"F16", 3, 186},
+        {"F17", 3, 187},
+        {"F18", 3, 188},
+        {"F19", 3, 189},
+        {"F20", 3, 190},
+        {"F21", 3, 191},
+        {"F22", 3, 192},
+        {"F23", 3, 193},
+        {"F24", 3, 194},
+        {"BrowserSearch", 13, 217}
+    };
+
+    constexpr int16_t KEY_DISPLACE[KEY_HASH_SIZE] = {
+        -256, 0, 0, -253, 0, 0, -252, 0, 0, 0, 1, -251, 1, 0, 0, 0,
+        0, -249, 0, 0, -248, 0, -247, -245, 1, 0, -242, -241, -240, 0, 0, -238,
+        -236, 0, 0, 0, -235, -233, -232, 0, 0, 0, -231, -230, 0, -228, 1, 1,
+        0, -227, 1, 0, 0, 0, 0, -224, 0, 0, 0, 0, 1, 0, 0, -223,
+        -222, -220, 0, 0, 0, -219, -218, 0, 1, 0, 1, -217, 0, -214, 0, -213,
+        0, -212, 0, 1, -209, 0, 0, -208, -207, 0, 0, 0, 0, 1, 0, 0,
+        0, 0, 1, -206, 1, 0, -205, 1, 0, 0, -203, 0, -200, -199, 0, 0,
+        0, 0, 0, 3, 0, 0, 0, 1, -198, -195, 0, -194, -193, -192, 2, 0,
+        0, 0, 0, -191, 0, 0, 0, 0, 1, 0, 1, -190, -189, -188, 0, -187,
+        0, 0, -186, 6, 0, 0, -185, 1, -183, -181, 0, -180, 0, -179, -177, 3,
+        0, 0, 0, 0, 0, 0, -176, 0, -175, -174, 0, -173, 0, -171, 3, 0,
+        0, 0, -168, 2, -167, 0, 0, 0, 0, -165, 0, 0, -164, 0, 1, 0,
+        -163, 0, 0, -162, -161, 1, 0, 0, 0, 0, 1, 0, -160, 0, 0, 1,
+        0, 0, 0, -159, 3, 0, 0, -158, -157, -156, -155, 0, -152, -151, 0, 0,
+        -150, 0, 0, -149, -147, 0, 1, -146, 0, -145, -143, -142, -141, 0, 0, 0,
+        -139, 0, -138, 0, 0, 2, 0, 0, 0, -137, -136, 0, -135, 0, 0, 2
+    };
+
+    constexpr int16_t KEY_SLOTS[KEY_HASH_SIZE] = {
+        45, 143, 57, -1, 40, -1, -1, 127, -1, 132, 49, -1, -1, -1, -1, -1,
+        72, -1, -1, -1, -1, -1, -1, -1, -1, 121, -1, 144, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, 65, -1, 136, -1, -1, -1, 35, -1, -1, -1, -1,
+        -1, 41, -1, -1, -1, 19, -1, -1, -1, -1, -1, 81, -1, -1, 117, -1,
+        -1, 139, -1, 64, -1, 157, -1, -1, -1, 97, -1, -1, -1, -1, -1, 134,
+        -1, 34, 125, -1, -1, -1, 15, -1, -1, 25, -1, 43, -1, -1, -1, -1,
+        -1, 79, -1, 120, 88, -1, -1, -1, -1, -1, -1, -1, 115, 112, 152, -1,
+        -1, -1, -1, -1, -1, 103, -1, 48, 123, -1, -1, -1, -1, -1, -1, -1,
+        -1, 44, -1, -1, -1, -1, 68, 18, 5, 118, 74, 80, 14, 17, 149, 60,
+        119, 90, 62, 47, 100, 151, 9, 113, 36, 102, 110, 155, 73, 26, 7, 13,
+        147, 69, 37, 54, 140, 71, 133, 10, 78, 38, 27, 116, 99, 70, 131, 111,
+        85, 46, 63, 108, 86, 122, 58, 50, 138, 145, 12, 30, 2, 91, 75, 150,
+        137, 98, 23, 89, 124, 67, 130, 101, 32, 92, 106, 104, 4, 128, 31, 148,
+        93, 87, 141, 59, 11, 55, 61, 24, 28, 156, 1, 16, 22, 6, 77, 29,
+        39, 105, 146, 114, 94, 142, 107, 0, 56, 126, 51, 154, 109, 3, 20, 95,
+        21, 129, 158, 8, 42, 83, 76, 135, 33, 153, 84, 96, 53, 52, 82, 66
+    };
+
+    constexpr int32_t KEY_NATIVE[KEY_CODE_LIMIT] = {
+        -1, 0x0001, 0x0002, 0x0003, 0x0004, 0x0005, 0x0006, 0x0007,
+        0x0008, 0x0009, 0x000A, 0x000B, 0x000C, 0x000D, 0x000E, 0x000F,
+        0x0010, 0x0011, 0x0012, 0x0013, 0x0014, 0x0015, 0x0016, 0x0017,
+        0x0018, 0x0019, 0x001A, 0x001B, 0x001C, 0x001D, 0x001E, 0x001F,
+        0x0020, 0x0021, 0x0022, 0x0023, 0x0024, 0x0025, 0x0026, 0x0027,
+        0x0028, 0x0029, 0x002A, 0x002B, 0x002C, 0x002D, 0x002E, 0x002F,
+        0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037,
+        0x0038, 0x0039, 0x003A, 0x003B, 0x003C, 0x003D, 0x003E, 0x003F,
+        0x0040, 0x0041, 0x0042, 0x0043, 0x0044, 0xE045, 0x0046, 0x0047,
+        0x0048, 0x0049, 0x004A, 0x004B, 0x004C, 0x004D, 0x004E, 0x004F,
+        0x0050, 0x0051, 0x0052, 0x0053, -1, -1, 0x0056, 0x0057,
+        0x0058, 0x0073, 0x0078, 0x0077, 0x0079, 0x0070, 0x007B, -1,
+        0xE01C, 0xE01D, 0xE035, 0xE037, 0xE038, -1, 0xE047, 0xE048,
+        0xE049, 0xE04B, 0xE04D, 0xE04F, 0xE050, 0xE051, 0xE052, 0xE053,
+        -1, 0xE020, 0xE02E, 0xE030, 0xE05E, 0x0059, -1, 0x0045,
+        -1, 0x007E, 0x0072, 0x0071, 0x007D, 0xE05B, 0xE05C, 0xE05D,
+        0xE068, -1, -1, 0xE008, -1, 0xE018, -1, 0xE00A,
+        -1, 0xE017, 0xE03B, -1, 0xE021, -1, 0xE05F, 0xE063,
+        0xE06B, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, 0xE06C, 0xE066, -1, 0xE06A, 0xE069,
+        -1, 0xE02C, -1, 0xE019, 0xE022, 0xE010, 0xE024, -1,
+        -1, -1, -1, 0xE06D, 0xE032, 0xE067, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, 0x0064,
+        0x0065, 0x0066, 0x0067, 0x0068, 0x0069, 0x006A, 0x006B, 0x006C,
+        0x006D, 0x006E, 0x0076, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, 0xE065, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1
+    };
+
+#elif defined(IS_MACOS)
+    constexpr uint32_t KEY_HASH_SIZE = 128;
+
+    constexpr KeyName KEY_NAMES[] = {
+        {"Escape", 6, 1},
+        {"Digit1", 6, 2},
+        {"Digit2", 6, 3},
+        {"Digit3", 6, 4},
+        {"Digit4", 6, 5},
+        {"Digit5", 6, 6},
+        {"Digit6", 6, 7},
+        {"Digit7", 6, 8},
+        {"Digit8", 6, 9},
+        {"Digit9", 6, 10},
+        {"Digit0", 6, 11},
+        {"Minus", 5, 12},
+        {"Equal", 5, 13},
+        {"Backspace", 9, 14},
+        {"Tab", 3, 15},
+        {"KeyQ", 4, 16},
+        {"KeyW", 4, 17},
+        {"KeyE", 4, 18},
+        {"KeyR", 4, 19},
+        {"KeyT", 4, 20},
+        {"KeyY", 4, 21},
+        {"KeyU", 4, 22},
+        {"KeyI", 4, 23},
+        {"KeyO", 4, 24},
+        {"KeyP", 4, 25},
+        {"BracketLeft", 11, 26},
+        {"BracketRight", 12, 27},
+        {"Enter", 5, 28},
+        {"ControlLeft", 11, 29},
+        {"KeyA", 4, 30},
+        {"KeyS", 4, 31},
+        {"KeyD", 4, 32},
+        {"KeyF", 4, 33},
+        {"KeyG", 4, 34},
+        {"KeyH", 4, 35},
+        {"KeyJ", 4, 36},
+        {"KeyK", 4, 37},
+        {"KeyL", 4, 38},
+        {"Semicolon", 9, 39},
+        {"Quote", 5, 40},
+        {"Backquote", 9, 41},
+        {"ShiftLeft", 9, 42},
+        {"Backslash", 9, 43},
+        {"KeyZ", 4, 44},
+        {"KeyX", 4, 45},
+        {"KeyC", 4, 46},
+        {"KeyV", 4, 47},
+        {"KeyB", 4, 48},
+        {"KeyN", 4, 49},
+        {"KeyM", 4, 50},
+        {"Comma", 5, 51},
+        {"Period", 6, 52},
+        {"Slash", 5, 53},
+        {"ShiftRight", 10, 54},
+        {"NumpadMultiply", 14, 55},
+        {"AltLeft", 7, 56},
+        {"Space", 5, 57},
+        {"CapsLock", 8, 58},
+        {"F1", 2, 59},
+        {"F2", 2, 60},
+        {"F3", 2, 61},
+        {"F4", 2, 62},
+        {"F5", 2, 63},
+        {"F6", 2, 64},
+        {"F7", 2, 65},
+        {"F8", 2, 66},
+        {"F9", 2, 67},
+        {"F10", 3, 68},
+        {"NumLock", 7, 69},
+        {"Numpad7", 7, 71},
+        {"Numpad8", 7, 72},
+        {"Numpad9", 7, 73},
+        {"NumpadSubtract", 14, 74},
+        {"Numpad4", 7, 75},
+        {"Numpad5", 7, 76},
+        {"Numpad6", 7, 77},
+        {"NumpadAdd", 9, 78},
+        {"Numpad1", 7, 79},
+        {"Numpad2", 7, 80},
+        {"Numpad3", 7, 81},
+        {"Numpad0", 7, 82},
+        {"NumpadDecimal", 13, 83},
+        {"IntlBackslash", 13, 86},
+        {"F11", 3, 87},
+        {"F12", 3, 88},
+        {"IntlRo", 6, 89},
+        {"NumpadEnter", 11, 96},
+        {"ControlRight", 12, 97},
+        {"NumpadDivide", 12, 98},
+        {"AltRight", 8, 100},
+        {"Home", 4, 102},
+        {"ArrowUp", 7, 103},
+        {"PageUp", 6, 104},
+        {"ArrowLeft", 9, 105},
+        {"ArrowRight", 10, 106},
+        {"End", 3, 107},
+        {"ArrowDown", 9, 108},
+        {"PageDown", 8, 109},
+        {"Insert", 6, 110},
+        {"Delete", 6, 111},
+        {"VolumeMute", 10, 113},
+        {"AudioVolumeMute", 15, 113},
+        {"VolumeDown", 10, 114},
+        {"AudioVolumeDown", 15, 114},
+        {"VolumeUp", 8, 115},
+        {"AudioVolumeUp", 13, 115},
+        {"NumpadEqual", 11, 117},
+        {"NumpadComma", 11, 121},
+        {"Lang1", 5, 122},
+        {"Lang2", 5, 123},
+        {"IntlYen", 7, 124},
+        {"MetaLeft", 8, 125},
+        {"OSLeft", 6, 125},
+        {"MetaRight", 9, 126},
+        {"OSRight", 7, 126},
+        {"ContextMenu", 11, 127},
+        {"Help", 4, 138},
+        {"F13", 3, 183},
+        {"F14", 3, 184},
+        {"F15", 3, 185},
+        {"F16", 3, 186},
+        {"F17", 3, 187},
+        {"F18", 3, 188},
+        {"F19", 3, 189},
+        {"F20", 3, 190},
+        {"Fn", 2, 464}
+    };
+
+    constexpr int16_t KEY_DISPLACE[KEY_HASH_SIZE] = {
+        -123, 0, 0, 3, 0, 0, -122, 0, -116, 0, 1, -115, 1, -110, 0, -108,
+        0, -107, 0, 6, 0, 0, -104, 2, 2, -103, -102, 4, 0, -96, -92, 1,
+        0, 0, 0, 0, -85, -84, 1, 0, 0, -83, -81, -77, 0, -74, 2, 2,
+        0, -71, 2, -70, 0, 0, 0, -65, 0, 0, 0, 0, 1, 0, 1, -59,
+        2, -58, 0, 0, -57, 3, -48, 0, -47, 0, 2, -46, -45, -40, 0, 5,
+        0, -37, 0, 4, 1, 0, 0, 3, 4, 0, -34, 0, -33, 1, 0, 0,
+        -32, 0, 8, -30, -28, 0, 1, 5, 0, -24, 13, -23, 3, 0, 0, 0,
+        -22, 0, -20, 3, 0, 1, 0, 11, -18, 3, -17, -15, -12, -11, 5, 0
+    };
+
+    constexpr int16_t KEY_SLOTS[KEY_HASH_SIZE] = {
+        45, 44, 36, -1, 31, -1, 58, 102, 8, 42, 121, 68, 26, 57, 91, 60,
+        18, 67, 20, 110, 47, 73, 17, 111, 46, 113, 78, 62, 77, 93, 3, 122,
+        106, 104, 119, 70, 59, 65, 50, 55, 41, 38, 15, 108, 13, 28, 98, 100,
+        96, 2, 39, 99, 71, 114, 23, 0, 118, 16, 76, 80, 53, 103, 22, 94,
+        29, 87, 5, 64, 61, 124, 117, 21, 11, 27, 86, 97, 92, 105, 79, 7,
+        101, 34, 69, 56, 51, 14, 37, 4, 125, 25, 43, 84, 72, 40, 74, 63,
+        9, 54, 6, 112, 88, 116, 85, 75, 82, 24, 33, 12, 90, 30, 123, 115,
+        10, 107, 83, 19, 95, 120, 1, 48, 109, 89, 66, 32, 35, 52, 81, 49
+    };
+
+    constexpr int32_t KEY_NATIVE[KEY_CODE_LIMIT] = {
+        -1, kVK_Escape, kVK_ANSI_1, kVK_ANSI_2, kVK_ANSI_3, kVK_ANSI_4, kVK_ANSI_5, kVK_ANSI_6,
+        kVK_ANSI_7, kVK_ANSI_8, kVK_ANSI_9, kVK_ANSI_0, kVK_ANSI_Minus, kVK_ANSI_Equal, kVK_Delete, kVK_Tab,
+        kVK_ANSI_Q, kVK_ANSI_W, kVK_ANSI_E, kVK_ANSI_R, kVK_ANSI_T, kVK_ANSI_Y, kVK_ANSI_U, kVK_ANSI_I,
+        kVK_ANSI_O, kVK_ANSI_P, kVK_ANSI_LeftBracket, kVK_ANSI_RightBracket, kVK_Return, kVK_Control, kVK_ANSI_A, kVK_ANSI_S,
+        kVK_ANSI_D, kVK_ANSI_F, kVK_ANSI_G, kVK_ANSI_H, kVK_ANSI_J, kVK_ANSI_K, kVK_ANSI_L, kVK_ANSI_Semicolon,
+        kVK_ANSI_Quote, kVK_ANSI_Grave, kVK_Shift, kVK_ANSI_Backslash, kVK_ANSI_Z, kVK_ANSI_X, kVK_ANSI_C, kVK_ANSI_V,
+        kVK_ANSI_B, kVK_ANSI_N, kVK_ANSI_M, kVK_ANSI_Comma, kVK_ANSI_Period, kVK_ANSI_Slash, kVK_RightShift, kVK_ANSI_KeypadMultiply,
+        kVK_Option, kVK_Space, kVK_CapsLock, kVK_F1, kVK_F2, kVK_F3, kVK_F4, kVK_F5,
+        kVK_F6, kVK_F7, kVK_F8, kVK_F9, kVK_F10, kVK_ANSI_KeypadClear, -1, kVK_ANSI_Keypad7,
+        kVK_ANSI_Keypad8, kVK_ANSI_Keypad9, kVK_ANSI_KeypadMinus, kVK_ANSI_Keypad4, kVK_ANSI_Keypad5, kVK_ANSI_Keypad6, kVK_ANSI_KeypadPlus, kVK_ANSI_Keypad1,
+        kVK_ANSI_Keypad2, kVK_ANSI_Keypad3, kVK_ANSI_Keypad0, kVK_ANSI_KeypadDecimal, -1, -1, kVK_ISO_Section, kVK_F11,
+        kVK_F12, kVK_JIS_Underscore, -1, -1, -1, -1, -1, -1,
+        kVK_ANSI_KeypadEnter, kVK_RightControl, kVK_ANSI_KeypadDivide, -1, kVK_RightOption, -1, kVK_Home, kVK_UpArrow,
+        kVK_PageUp, kVK_LeftArrow, kVK_RightArrow, kVK_End, kVK_DownArrow, kVK_PageDown, kVK_Help, kVK_ForwardDelete,
+        -1, kVK_Mute, kVK_VolumeDown, kVK_VolumeUp, -1, kVK_ANSI_KeypadEquals, -1, -1,
+        -1, kVK_JIS_KeypadComma, kVK_JIS_Kana, kVK_JIS_Eisu, kVK_JIS_Yen, kVK_Command, 0x36, 0x6E,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, kVK_Help, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, kVK_F13,
+        kVK_F14, kVK_F15, kVK_F16, kVK_F17, kVK_F18, kVK_F19, kVK_F20, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        kVK_Function, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1
+    };
+#endif
+
+constexpr uint32_t KeyHash(const char* name, size_t length, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Numeric code of the name, -1 if the platform has no such key
+constexpr int KeyCodeFromName(const char* name, size_t length) {
+    int32_t displace = KEY_DISPLACE[KeyHash(name, length, 0) & (KEY_HASH_SIZE - 1)];
+    uint32_t slot = displace < 0 ? (uint32_t)(-displace - 1) : KeyHash(name, length, displace) & (KEY_HASH_SIZE - 1);
+    int16_t index = KEY_SLOTS[slot];
+    if (index < 0 || KEY_NAMES[index].length != length) {
+        return -1;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (KEY_NAMES[index].name[i] != name[i]) {
+            return -1;
+        }
+    }
+    return KEY_NAMES[index].code;
+}
+
+// Native code of the numeric code (Linux KEY_*, Windows scan code, macOS virtual key), -1 if unsupported
+constexpr int32_t KeyNativeFromCode(int code) {
+    return code >= 0 && code < KEY_CODE_LIMIT ? KEY_NATIVE[code] : -1;
+}
+
+static_assert(KeyCodeFromName("Escape", 6) == 1, "Key table is broken");
+static_assert(KeyCodeFromName("Escapf", 6) == -1, "Key table is broken");
+
+#endif
@@ -38,6 +38,7 @@
 #include "keyboard.h"
 #include "gamepad.h"
 #include "screen.h"
+#include "injector.h"
 
 
 Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
@@ -46,6 +47,7 @@ Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
     obj.Set(Napi::String::New(env, "Keyboard"), Keyboard::Init(env, exports));
     obj.Set(Napi::String::New(env, "Gamepad"), Gamepad::Init(env, exports));
     obj.Set(Napi::String::New(env, "Screen"), IScreen::Init(env, exports));
+    Injector::Init(env, obj);
 
     return obj;
 }
@@ -1,5 +1,6 @@
 #include "mouse.h"
 
+#include <algorithm>
 #include <vector>
 
 #if defined(IS_WINDOWS)
@@ -13,15 +14,203 @@
     #include <X11/Xlib.h>
     #include <X11/extensions/XTest.h>
     #include <X11/extensions/Xfixes.h>
+    #include "display.h"
+    #include "injector.h"
+    #include "uinput.h"
+
+    #include <atomic>
+    #include <thread>
+    #include <errno.h>
+    #include <poll.h>
+    #include <string.h>
+    #include <unistd.h>
+    #include <sys/eventfd.h>
+    #include <sys/ioctl.h>
+
+    // Virtual pointer of the uinput backend, -1 while the X11 backend is selected
+    static int pointerFd = -1;
+
+    // Create a uinput pointer with absolute axes matching the screen size in pixels
+    static int PointerCreate(int width, int height) {
+        int fd = UinputOpen();
+        if (fd < 0) {
+            return -1;
+        }
+
+        ioctl(fd, UI_SET_EVBIT, EV_KEY);
+        ioctl(fd, UI_SET_EVBIT, EV_REL);
+        ioctl(fd, UI_SET_EVBIT, EV_ABS);
+
+        ioctl(fd, UI_SET_KEYBIT, BTN_LEFT);
+        ioctl(fd, UI_SET_KEYBIT, BTN_RIGHT);
+        ioctl(fd, UI_SET_KEYBIT, BTN_MIDDLE);
+        ioctl(fd, UI_SET_KEYBIT, BTN_SIDE);     // Back
+        ioctl(fd, UI_SET_KEYBIT, BTN_EXTRA);    // Forward
+
+        ioctl(fd, UI_SET_RELBIT, REL_X);
+        ioctl(fd, UI_SET_RELBIT, REL_Y);
+        ioctl(fd, UI_SET_RELBIT, REL_WHEEL);
+        ioctl(fd, UI_SET_RELBIT, REL_HWHEEL);
+
+        ioctl(fd, UI_SET_ABSBIT, ABS_X);
+        ioctl(fd, UI_SET_ABSBIT, ABS_Y);
+        ioctl(fd, UI_SET_PROPBIT, INPUT_PROP_POINTER);
+
+        // One absolute unit is one pixel
+        struct uinput_abs_setup abs_setup;
+        memset(&abs_setup, 0, sizeof(abs_setup));
+        abs_setup.code = ABS_X;
+        abs_setup.absinfo.minimum = 0;
+        abs_setup.absinfo.maximum = width - 1;
+        ioctl(fd, UI_ABS_SETUP, &abs_setup);
+
+        abs_setup.code = ABS_Y;
+        abs_setup.absinfo.maximum = height - 1;
+        ioctl(fd, UI_ABS_SETUP, &abs_setup);
+
+        struct uinput_setup usetup;
+        memset(&usetup, 0, sizeof(usetup));
+        usetup.id.bustype = BUS_VIRTUAL;
+        usetup.id.version = 1;
+        strncpy(usetup.name, "Virtual Pointer", UINPUT_MAX_NAME_SIZE);
+
+        if (ioctl(fd, UI_DEV_SETUP, &usetup) < 0 || ioctl(fd, UI_DEV_CREATE) < 0) {
+            close(fd);
+            return -1;
+        }
+
+        // Give the system time to create the device
+        usleep(100000); // 100ms delay
 
-    // Helper function to get the main X11 display
-    // Returns a singleton Display* connection
-    inline Display* XGetMainDisplay() {
-        static Display* display = nullptr;
-        if (display == nullptr) {
-            display = XOpenDisplay(nullptr);
+        return fd;
+    }
+
+    static void PointerDestroy() {
+        if (pointerFd < 0) {
+            return;
         }
-        return display;
+        // Queued commands may still reference the device
+        Injector::Drain();
+        ioctl(pointerFd, UI_DEV_DESTROY);
+        close(pointerFd);
+        pointerFd = -1;
+    }
+
+    // Last cursor image returned by getIcon, keyed by the XFixes cursor serial
+    static Napi::ObjectReference iconCache;
+    static unsigned long iconSerial = 0;
+
+    // Cursor image copied on the watcher thread
+    struct CursorIcon {
+        int width;
+        int height;
+        int xOffset;
+        int yOffset;
+        unsigned long serial;
+        std::vector<uint32_t> pixels;
+    };
+
+    // Cursor change watcher state
+    static std::thread iconThread;
+    static std::atomic<bool> iconStop{false};
+    static std::atomic<bool> iconDisplayBroken{false};
+    static int iconWakeFd = -1;
+    static Napi::ThreadSafeFunction iconTsfn;
+
+    // Runs on the watcher thread with its own connection, waits for XFixes cursor notify events
+    static void IconWatchLoop(Display* display, int eventBase) {
+        Window root = DefaultRootWindow(display);
+        XFixesSelectCursorInput(display, root, XFixesDisplayCursorNotifyMask);
+        XFlush(display);
+
+        struct pollfd fds[2];
+        fds[0].fd = ConnectionNumber(display);
+        fds[0].events = POLLIN;
+        fds[1].fd = iconWakeFd;
+        fds[1].events = POLLIN;
+
+        unsigned long lastSerial = 0;
+        while (!iconStop.load()) {
+            // Sleep only when Xlib has no buffered event
+            if (XPending(display) == 0) {
+                // The server went away, the socket would wake poll() forever
+                if (iconDisplayBroken.load()) {
+                    break;
+                }
+                if (poll(fds, 2, -1) < 0 && errno != EINTR) {
+                    break;
+                }
+                continue;
+            }
+
+            XEvent event;
+            XNextEvent(display, &event);
+            if (event.type != eventBase + XFixesCursorNotify) {
+                continue;
+            }
+            XFixesCursorNotifyEvent* notify = (XFixesCursorNotifyEvent*)&event;
+            if (notify->cursor_serial == lastSerial) {
+                continue;
+            }
+
+            XFixesCursorImage* cursorImage = XFixesGetCursorImage(display);
+            if (cursorImage == NULL) {
+                continue;
+            }
+            lastSerial = cursorImage->cursor_serial;
+
+            CursorIcon* icon = new CursorIcon();
+            icon->width = cursorImage->width;
+            icon->height = cursorImage->height;
+            icon->xOffset = cursorImage->xhot;
+            icon->yOffset = cursorImage->yhot;
+            icon->serial = cursorImage->cursor_serial;
+            icon->pixels.resize(icon->width * icon->height);
+            for (int i = 0; i < icon->width * icon->height; i++) {
+                icon->pixels[i] = (uint32_t)cursorImage->pixels[i];
+            }
+            XFree(cursorImage);
+
+            auto deliver = [](Napi::Env env, Napi::Function jsCallback, CursorIcon* icon) {
+                Napi::Object result = Napi::Object::New(env);
+                Napi::Uint32Array pixelData = Napi::Uint32Array::New(env, icon->pixels.size());
+                std::copy(icon->pixels.begin(), icon->pixels.end(), pixelData.Data());
+
+                result.Set("width", icon->width);
+                result.Set("height", icon->height);
+                result.Set("data", pixelData);
+                result.Set("xOffset", icon->xOffset);
+                result.Set("yOffset", icon->yOffset);
+
+                // Later getIcon calls with the same serial return this object
+                iconSerial = icon->serial;
+                iconCache.Reset(result, 1);
+                iconCache.SuppressDestruct();
+
+                delete icon;
+                jsCallback.Call({result});
+            };
+            if (iconTsfn.NonBlockingCall(icon, deliver) != napi_ok) {
+                delete icon;
+            }
+        }
+
+        XCloseDisplay(display);
+    }
+
+    static void IconWatchStop() {
+        if (!iconThread.joinable()) {
+            return;
+        }
+        iconStop.store(true);
+        // Wake up the poll() of the watcher thread
+        uint64_t one = 1;
+        ssize_t written = write(iconWakeFd, &one, sizeof(one));
+        (void)written;
+        iconThread.join();
+        close(iconWakeFd);
+        iconWakeFd = -1;
+        iconTsfn.Release();
     }
 #endif
 
@@ -148,7 +337,7 @@ Napi::Object Mouse::getIcon(const Napi::CallbackInfo& info) {
         if (!GetCursorInfo(&ci)) {
             result.Set("width", 0);
             result.Set("height", 0);
-            result.Set("data", Napi::Array::New(env, 0));
+            result.Set("data", Napi::Uint32Array::New(env, 0));
 			result.Set("xOffset", 0);
 			result.Set("yOffset", 0);
             return result;
@@ -159,7 +348,7 @@ Napi::Object Mouse::getIcon(const Napi::CallbackInfo& info) {
         if (!GetIconInfo(ci.hCursor, &iconInfo)) {
             result.Set("width", 0);
             result.Set("height", 0);
-            result.Set("data", Napi::Array::New(env, 0));
+            result.Set("data", Napi::Uint32Array::New(env, 0));
 			result.Set("xOffset", 0);
 			result.Set("yOffset", 0);
             return result;
@@ -185,11 +374,12 @@ Napi::Object Mouse::getIcon(const Napi::CallbackInfo& info) {
         DrawIconEx(hdcMem, 0, 0, ci.hCursor, width, height, 0, NULL, DI_NORMAL);
 
         // Get the pixel data
-        Napi::Array pixelData = Napi::Array::New(env, width * height);
+        Napi::Uint32Array pixelData = Napi::Uint32Array::New(env, width * height);
+        uint32_t* pixels = pixelData.Data();
         for (int y = 0; y < height; y++) {
             for (int x = 0; x < width; x++) {
                 COLORREF clr = GetPixel(hdcMem, x, y);
-                pixelData.Set(y * width + x, clr);
+                pixels[y * width + x] = clr;
             }
         }
 
@@ -217,7 +407,7 @@ Napi::Object Mouse::getIcon(const Napi::CallbackInfo& info) {
         if (cursor == nil) {
             result.Set("width", 0);
             result.Set("height", 0);
-            result.Set("data", Napi::Array::New(env, 0));
+            result.Set("data", Napi::Uint32Array::New(env, 0));
             result.Set("xOffset", 0);
             result.Set("yOffset", 0);
             return result;
@@ -229,7 +419,7 @@ Napi::Object Mouse::getIcon(const Napi::CallbackInfo& info) {
         if (image == nil) {
             result.Set("width", 0);
             result.Set("height", 0);
-            result.Set("data", Napi::Array::New(env, 0));
+            result.Set("data", Napi::Uint32Array::New(env, 0));
             result.Set("xOffset", 0);
             result.Set("yOffset", 0);
             return result;
@@ -260,7 +450,8 @@ Napi::Object Mouse::getIcon(const Napi::CallbackInfo& info) {
 
         // Extract pixel data
         unsigned char *bitmapData = [bitmap bitmapData];
-        Napi::Array pixelData = Napi::Array::New(env, width * height);
+        Napi::Uint32Array pixelData = Napi::Uint32Array::New(env, width * height);
+        uint32_t* pixels = pixelData.Data();
         
         for (int y = 0; y < height; y++) {
             for (int x = 0; x < width; x++) {
@@ -272,7 +463,7 @@ Napi::Object Mouse::getIcon(const Napi::CallbackInfo& info) {
                 
                 // Convert to COLORREF format (0x00BBGGRR) with alpha in high byte
                 uint32_t color = (a << 24) | (r << 16) | (g << 8) | b;
-                pixelData.Set(y * width + x, color);
+                pixels[y * width + x] = color;
             }
         }
 
@@ -289,38 +480,42 @@ Napi::Object Mouse::getIcon(const Napi::CallbackInfo& info) {
         if (display == NULL) {
             result.Set("width", 0);
             result.Set("height", 0);
-            result.Set("data", Napi::Array::New(env, 0));
+            result.Set("data", Napi::Uint32Array::New(env, 0));
             result.Set("xOffset", 0);
             result.Set("yOffset", 0);
             return result;
         }
 
-        Window root = DefaultRootWindow(display);
-        
         // Query the cursor image using XFixes extension
         XFixesCursorImage *cursorImage = XFixesGetCursorImage(display);
         if (cursorImage == NULL) {
             result.Set("width", 0);
             result.Set("height", 0);
-            result.Set("data", Napi::Array::New(env, 0));
+            result.Set("data", Napi::Uint32Array::New(env, 0));
             result.Set("xOffset", 0);
             result.Set("yOffset", 0);
             return result;
         }
 
+        // Unchanged cursor, return the cached image without copying pixels
+        if (!iconCache.IsEmpty() && cursorImage->cursor_serial == iconSerial) {
+            XFree(cursorImage);
+            return iconCache.Value();
+        }
+
         int width = cursorImage->width;
         int height = cursorImage->height;
         int xOffset = cursorImage->xhot;
         int yOffset = cursorImage->yhot;
 
         // Extract pixel data (XFixes returns ARGB format as unsigned long)
-        Napi::Array pixelData = Napi::Array::New(env, width * height);
+        Napi::Uint32Array pixelData = Napi::Uint32Array::New(env, width * height);
+        uint32_t* pixels = pixelData.Data();
         for (int i = 0; i < width * height; i++) {
-            // XFixes cursor pixels are in ARGB format
-            unsigned long pixel = cursorImage->pixels[i];
-            pixelData.Set(i, (uint32_t)pixel);
+            pixels[i] = (uint32_t)cursorImage->pixels[i];
         }
 
+        iconSerial = cursorImage->cursor_serial;
         XFree(cursorImage);
 
         result.Set("width", width);
@@ -328,6 +523,9 @@ Napi::Object Mouse::getIcon(const Napi::CallbackInfo& info) {
         result.Set("data", pixelData);
         result.Set("xOffset", xOffset);
         result.Set("yOffset", yOffset);
+
+        iconCache.Reset(result, 1);
+        iconCache.SuppressDestruct();
         
         return result;
 
@@ -336,6 +534,64 @@ Napi::Object Mouse::getIcon(const Napi::CallbackInfo& info) {
 }
 
 
+void Mouse::onIconChange(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1) {
+        Napi::TypeError::New(env, "Expected 1 argument").ThrowAsJavaScriptException();
+        return;
+    }
+
+    if (!info[0].IsFunction() && !info[0].IsNull()) {
+        Napi::TypeError::New(env, "Expected function or null argument").ThrowAsJavaScriptException();
+        return;
+    }
+
+    #if defined(IS_LINUX)
+        // Replace the previous listener
+        IconWatchStop();
+        if (info[0].IsNull()) {
+            return;
+        }
+
+        // Losing the server ends the watcher thread instead of the process
+        Display* display = XOpenThreadDisplay(&iconDisplayBroken);
+        if (display == NULL) {
+            Napi::Error::New(env, "Failed to open X display").ThrowAsJavaScriptException();
+            return;
+        }
+
+        int eventBase, errorBase;
+        if (!XFixesQueryExtension(display, &eventBase, &errorBase)) {
+            XCloseDisplay(display);
+            Napi::Error::New(env, "XFixes extension not available").ThrowAsJavaScriptException();
+            return;
+        }
+
+        iconWakeFd = eventfd(0, EFD_CLOEXEC);
+        if (iconWakeFd < 0) {
+            XCloseDisplay(display);
+            Napi::Error::New(env, "Failed to create cursor watcher").ThrowAsJavaScriptException();
+            return;
+        }
+
+        iconTsfn = Napi::ThreadSafeFunction::New(env, info[0].As<Napi::Function>(), "IconChange", 0, 1);
+        // A listener alone does not keep the process running
+        iconTsfn.Unref(env);
+        iconStop.store(false);
+        iconThread = std::thread(IconWatchLoop, display, eventBase);
+
+    #else
+        if (!info[0].IsNull()) {
+            Napi::Error::New(env, "Cursor change events are not supported on this platform").ThrowAsJavaScriptException();
+            return;
+        }
+    #endif
+
+    return;
+}
+
+
 void Mouse::setX(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     if (info.Length() < 1) {
@@ -367,25 +623,15 @@ void Mouse::setX(const Napi::CallbackInfo& info) {
         CGWarpMouseCursorPosition(newPosition);
 
     #elif defined(IS_LINUX)
-        Display *display = XGetMainDisplay();
-        if (display == NULL) {
+        if (pointerFd >= 0) {
+            // The device keeps its last ABS_Y, a physical mouse move in between is not seen
+            Injector::Submit({INJECT_UINPUT_EVENT, pointerFd, EV_ABS, ABS_X, x});
             return;
         }
-        
-        Window root = DefaultRootWindow(display);
-        Window window_returned;
-        int root_x, root_y;
-        int win_x, win_y;
-        unsigned int mask_return;
-        
-        // Get current Y position
-        XQueryPointer(display, root, &window_returned,
-            &window_returned, &root_x, &root_y,
-            &win_x, &win_y, &mask_return);
-        
+
         // Move cursor to new X position, keeping Y the same
-        XWarpPointer(display, None, root, 0, 0, 0, 0, x, root_y);
-        XFlush(display);
+        Injector::Submit({INJECT_MOUSE_SET_X, x, 0, 0, 0});
+        Injector::Commit();
 
     #endif
 
@@ -424,25 +670,100 @@ void Mouse::setY(const Napi::CallbackInfo& info) {
         CGWarpMouseCursorPosition(newPosition);
 
     #elif defined(IS_LINUX)
-        Display *display = XGetMainDisplay();
-        if (display == NULL) {
+        if (pointerFd >= 0) {
+            // The device keeps its last ABS_X, a physical mouse move in between is not seen
+            Injector::Submit({INJECT_UINPUT_EVENT, pointerFd, EV_ABS, ABS_Y, y});
             return;
         }
+
+        // Move cursor to new Y position, keeping X the same
+        Injector::Submit({INJECT_MOUSE_SET_Y, y, 0, 0, 0});
+        Injector::Commit();
+
+    #endif
+
+    return;
+}
+
+
+void Mouse::setPosition(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 2) {
+        Napi::TypeError::New(env, "Expected 2 argument").ThrowAsJavaScriptException();
+        return;
+    }
+
+    if (!info[0].IsNumber() || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Expected number arguments").ThrowAsJavaScriptException();
+        return;
+    }
+
+    int x = info[0].As<Napi::Number>().Int32Value();
+    int y = info[1].As<Napi::Number>().Int32Value();
+
+    #if defined(IS_WINDOWS)
+        SetCursorPos(x, y);
+
+    #elif defined(IS_MACOS)
+        CGPoint newPosition;
+        newPosition.x = (CGFloat)x;
+        newPosition.y = (CGFloat)y;
         
-        Window root = DefaultRootWindow(display);
-        Window window_returned;
-        int root_x, root_y;
-        int win_x, win_y;
-        unsigned int mask_return;
+        CGWarpMouseCursorPosition(newPosition);
+
+    #elif defined(IS_LINUX)
+        // Single warp or uinput frame to the absolute position, no pointer query needed
+        Injector::Submit(Mouse::MoveCommand(x, y));
+        Injector::Commit();
+
+    #endif
+
+    return;
+}
+
+void Mouse::moveBy(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 2) {
+        Napi::TypeError::New(env, "Expected 2 argument").ThrowAsJavaScriptException();
+        return;
+    }
+
+    if (!info[0].IsNumber() || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Expected number arguments").ThrowAsJavaScriptException();
+        return;
+    }
+
+    int dx = info[0].As<Napi::Number>().Int32Value();
+    int dy = info[1].As<Napi::Number>().Int32Value();
+
+    #if defined(IS_WINDOWS)
+        POINT point;
+        GetCursorPos(&point);
+        SetCursorPos(point.x + dx, point.y + dy);
+
+    #elif defined(IS_MACOS)
+        CGEventRef event = CGEventCreate(NULL);
+        CGPoint cursor = CGEventGetLocation(event);
+        CFRelease(event);
         
-        // Get current X position
-        XQueryPointer(display, root, &window_returned,
-            &window_returned, &root_x, &root_y,
-            &win_x, &win_y, &mask_return);
+        CGPoint newPosition;
+        newPosition.x = cursor.x + (CGFloat)dx;
+        newPosition.y = cursor.y + (CGFloat)dy;
         
-        // Move cursor to new Y position, keeping X the same
-        XWarpPointer(display, None, root, 0, 0, 0, 0, root_x, y);
-        XFlush(display);
+        CGWarpMouseCursorPosition(newPosition);
+
+    #elif defined(IS_LINUX)
+        if (pointerFd >= 0) {
+            // Relative motion, the compositor applies its pointer acceleration
+            Injector::Submit({INJECT_UINPUT_REL_XY, pointerFd, dx, dy, 0});
+            return;
+        }
+
+        // Relative warp is resolved by the server, no pointer query needed
+        Injector::Submit({INJECT_MOUSE_MOVE_BY, dx, dy, 0, 0});
+        Injector::Commit();
 
     #endif
 
@@ -529,27 +850,22 @@ void Mouse::buttonDown(const Napi::CallbackInfo& info) {
         }
 
     #elif defined(IS_LINUX)
-        Display *display = XGetMainDisplay();
-        if (display == NULL) {
-            return;
-        }
-        
-        unsigned int xButton;
+        int buttonIndex = 0;
         
         if (button == "left") {
-            xButton = Button1;
+            buttonIndex = 0;
         } else if (button == "middle") {
-            xButton = Button2;
+            buttonIndex = 1;
         } else if (button == "right") {
-            xButton = Button3;
+            buttonIndex = 2;
         } else if (button == "back") {
-            xButton = 8; // X11 back button
+            buttonIndex = 3;
         } else if (button == "forward") {
-            xButton = 9; // X11 forward button
+            buttonIndex = 4;
         }
         
-        XTestFakeButtonEvent(display, xButton, True, CurrentTime);
-        XFlush(display);
+        Injector::Submit(Mouse::ButtonCommand(buttonIndex, true));
+        Injector::Commit();
 
     #endif
 
@@ -635,27 +951,22 @@ void Mouse::buttonUp(const Napi::CallbackInfo& info) {
         }
 
     #elif defined(IS_LINUX)
-        Display *display = XGetMainDisplay();
-        if (display == NULL) {
-            return;
-        }
-        
-        unsigned int xButton;
+        int buttonIndex = 0;
         
         if (button == "left") {
-            xButton = Button1;
+            buttonIndex = 0;
         } else if (button == "middle") {
-            xButton = Button2;
+            buttonIndex = 1;
         } else if (button == "right") {
-            xButton = Button3;
+            buttonIndex = 2;
         } else if (button == "back") {
-            xButton = 8; // X11 back button
+            buttonIndex = 3;
         } else if (button == "forward") {
-            xButton = 9; // X11 forward button
+            buttonIndex = 4;
         }
         
-        XTestFakeButtonEvent(display, xButton, False, CurrentTime);
-        XFlush(display);
+        Injector::Submit(Mouse::ButtonCommand(buttonIndex, false));
+        Injector::Commit();
 
     #endif
 
@@ -718,28 +1029,13 @@ void Mouse::scrollDown(const Napi::CallbackInfo& info) {
         CFRelease(scrollEvent);
 
     #elif defined(IS_LINUX)
-        Display *display = XGetMainDisplay();
-        if (display == NULL) {
+        if (amount <= 0) {
             return;
         }
-        
-        unsigned int button;
-        
-        if (isHorizontal) {
-            // Horizontal scroll right (button 7)
-            button = 7;
-        } else {
-            // Vertical scroll down (button 5)
-            button = 5;
-        }
-        
-        // Simulate multiple scroll events based on amount
-        for (int i = 0; i < amount; i++) {
-            XTestFakeButtonEvent(display, button, True, CurrentTime);
-            XTestFakeButtonEvent(display, button, False, CurrentTime);
-        }
-        
-        XFlush(display);
+
+        // Down or right scroll
+        Injector::Submit(Mouse::ScrollCommand(amount, isHorizontal));
+        Injector::Commit();
 
     #endif
 
@@ -801,34 +1097,136 @@ void Mouse::scrollUp(const Napi::CallbackInfo& info) {
         CFRelease(scrollEvent);
 
     #elif defined(IS_LINUX)
-        Display *display = XGetMainDisplay();
-        if (display == NULL) {
+        if (amount <= 0) {
             return;
         }
-        
-        unsigned int button;
-        
-        if (isHorizontal) {
-            // Horizontal scroll left (button 6)
-            button = 6;
-        } else {
-            // Vertical scroll up (button 4)
-            button = 4;
+
+        // Up or left scroll
+        Injector::Submit(Mouse::ScrollCommand(-amount, isHorizontal));
+        Injector::Commit();
+
+    #endif
+
+    return;
+}
+
+
+void Mouse::setBackend(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1) {
+        Napi::TypeError::New(env, "Expected 1 argument").ThrowAsJavaScriptException();
+        return;
+    }
+
+    if (!info[0].IsString()) {
+        Napi::TypeError::New(env, "Expected string argument").ThrowAsJavaScriptException();
+        return;
+    }
+
+    std::string backend = info[0].As<Napi::String>().Utf8Value();
+
+    #if defined(IS_LINUX)
+        if (backend != "x11" && backend != "uinput") {
+            Napi::TypeError::New(env, "Expected 'x11' or 'uinput'").ThrowAsJavaScriptException();
+            return;
         }
-        
-        // Simulate multiple scroll events based on amount
-        for (int i = 0; i < amount; i++) {
-            XTestFakeButtonEvent(display, button, True, CurrentTime);
-            XTestFakeButtonEvent(display, button, False, CurrentTime);
+
+        int width = 0;
+        int height = 0;
+        if (info.Length() > 1 && !info[1].IsUndefined()) {
+            if (!info[1].IsObject()) {
+                Napi::TypeError::New(env, "Expected object in 2nd argument").ThrowAsJavaScriptException();
+                return;
+            }
+            Napi::Object options = info[1].As<Napi::Object>();
+            if (options.Has("width") && options.Has("height")) {
+                if (!options.Get("width").IsNumber() || !options.Get("height").IsNumber()) {
+                    Napi::TypeError::New(env, "Expected number width and height").ThrowAsJavaScriptException();
+                    return;
+                }
+                width = options.Get("width").As<Napi::Number>().Int32Value();
+                height = options.Get("height").As<Napi::Number>().Int32Value();
+            }
         }
-        
-        XFlush(display);
 
+        // Recreate the device on every switch so a new screen size applies
+        PointerDestroy();
+        if (backend == "x11") {
+            return;
+        }
+
+        if (width <= 0 || height <= 0) {
+            Display *display = XGetMainDisplay();
+            if (display == NULL) {
+                Napi::Error::New(env, "Failed to open X display, pass width and height").ThrowAsJavaScriptException();
+                return;
+            }
+            width = DisplayWidth(display, DefaultScreen(display));
+            height = DisplayHeight(display, DefaultScreen(display));
+        }
+
+        pointerFd = PointerCreate(width, height);
+        if (pointerFd < 0) {
+            Napi::Error::New(env, "Failed to create uinput pointer device").ThrowAsJavaScriptException();
+            return;
+        }
+
+    #else
+        if (backend != "native") {
+            Napi::Error::New(env, "Mouse backend is not supported on this platform").ThrowAsJavaScriptException();
+            return;
+        }
     #endif
 
     return;
 }
 
+Napi::String Mouse::getBackend(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    #if defined(IS_LINUX)
+        return Napi::String::New(env, pointerFd >= 0 ? "uinput" : "x11");
+    #else
+        return Napi::String::New(env, "native");
+    #endif
+}
+
+
+#if defined(IS_LINUX)
+InjectCommand Mouse::MoveCommand(int x, int y) {
+    if (pointerFd >= 0) {
+        return {INJECT_UINPUT_ABS_XY, pointerFd, x, y, 0};
+    }
+    return {INJECT_MOUSE_MOVE, x, y, 0, 0};
+}
+
+InjectCommand Mouse::ButtonCommand(int button, bool pressed) {
+    // left, middle, right, back, forward
+    static const int32_t xButtons[] = {Button1, Button2, Button3, 8, 9};
+    static const int32_t evButtons[] = {BTN_LEFT, BTN_MIDDLE, BTN_RIGHT, BTN_SIDE, BTN_EXTRA};
+
+    if (pointerFd >= 0) {
+        return {INJECT_UINPUT_EVENT, pointerFd, EV_KEY, evButtons[button], pressed ? 1 : 0};
+    }
+    return {INJECT_MOUSE_BUTTON, xButtons[button], pressed ? 1 : 0, 0, 0};
+}
+
+InjectCommand Mouse::ScrollCommand(int amount, bool isHorizontal) {
+    if (pointerFd >= 0) {
+        // One wheel event carries every click, positive REL_WHEEL scrolls up
+        if (isHorizontal) {
+            return {INJECT_UINPUT_EVENT, pointerFd, EV_REL, REL_HWHEEL, amount};
+        }
+        return {INJECT_UINPUT_EVENT, pointerFd, EV_REL, REL_WHEEL, -amount};
+    }
+
+    // X11 wheel buttons: 4 up, 5 down, 6 left, 7 right
+    int32_t button = isHorizontal ? (amount > 0 ? 7 : 6) : (amount > 0 ? 5 : 4);
+    return {INJECT_MOUSE_SCROLL, button, amount > 0 ? amount : -amount, 0, 0};
+}
+#endif
+
 
 Napi::Object Mouse::Init(Napi::Env env, Napi::Object exports) {
     Napi::Object obj = Napi::Object::New(env);
@@ -836,14 +1234,28 @@ Napi::Object Mouse::Init(Napi::Env env, Napi::Object exports) {
     obj.Set(Napi::String::New(env, "getY"), Napi::Function::New(env, Mouse::getY));
 
     obj.Set(Napi::String::New(env, "getIcon"), Napi::Function::New(env, Mouse::getIcon));
+    obj.Set(Napi::String::New(env, "onIconChange"), Napi::Function::New(env, Mouse::onIconChange));
 
     obj.Set(Napi::String::New(env, "setX"), Napi::Function::New(env, Mouse::setX));
     obj.Set(Napi::String::New(env, "setY"), Napi::Function::New(env, Mouse::setY));
+    obj.Set(Napi::String::New(env, "setPosition"), Napi::Function::New(env, Mouse::setPosition));
+    obj.Set(Napi::String::New(env, "moveBy"), Napi::Function::New(env, Mouse::moveBy));
 
     obj.Set(Napi::String::New(env, "buttonDown"), Napi::Function::New(env, Mouse::buttonDown));
     obj.Set(Napi::String::New(env, "buttonUp"), Napi::Function::New(env, Mouse::buttonUp));
 
     obj.Set(Napi::String::New(env, "scrollDown"), Napi::Function::New(env, Mouse::scrollDown));
     obj.Set(Napi::String::New(env, "scrollUp"), Napi::Function::New(env, Mouse::scrollUp));
+
+    obj.Set(Napi::String::New(env, "setBackend"), Napi::Function::New(env, Mouse::setBackend));
+    obj.Set(Napi::String::New(env, "getBackend"), Napi::Function::New(env, Mouse::getBackend));
+
+    #if defined(IS_LINUX)
+        // Join the cursor watcher and remove the virtual pointer before the environment goes away
+        napi_add_env_cleanup_hook(env, [](void* arg) {
+            IconWatchStop();
+            PointerDestroy();
+        }, nullptr);
+    #endif
     return obj;
 }
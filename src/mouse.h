@@ -4,18 +4,34 @@
 
 #include <napi.h>
 
+#if defined(IS_LINUX)
+    #include "injector.h"
+#endif
+
 class Mouse {
     public:
         static Napi::Object Init(Napi::Env env, Napi::Object exports);
         static Napi::Number getX(const Napi::CallbackInfo& info);
         static Napi::Number getY(const Napi::CallbackInfo& info);
         static Napi::Object getIcon(const Napi::CallbackInfo& info);
+        static void onIconChange(const Napi::CallbackInfo& info);
         static void setX(const Napi::CallbackInfo& info);
         static void setY(const Napi::CallbackInfo& info);
+        static void setPosition(const Napi::CallbackInfo& info);
+        static void moveBy(const Napi::CallbackInfo& info);
         static void buttonDown(const Napi::CallbackInfo& info);
         static void buttonUp(const Napi::CallbackInfo& info);
         static void scrollDown(const Napi::CallbackInfo& info);
         static void scrollUp(const Napi::CallbackInfo& info);
+        static void setBackend(const Napi::CallbackInfo& info);
+        static Napi::String getBackend(const Napi::CallbackInfo& info);
+
+        #if defined(IS_LINUX)
+            // Build the command for the selected backend
+            static InjectCommand MoveCommand(int x, int y);
+            static InjectCommand ButtonCommand(int button, bool pressed);   // 0 left, 1 middle, 2 right, 3 back, 4 forward
+            static InjectCommand ScrollCommand(int amount, bool isHorizontal);  // positive down/right, negative up/left
+        #endif
 };
 
 #endif
\ No newline at end of file
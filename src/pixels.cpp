@@ -0,0 +1,320 @@
+#include "pixels.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define PIXELS_X86
+    #include <immintrin.h>
+#endif
+
+// BT.601 limited range, 8 bit fixed point
+#define PIXELS_Y(r, g, b) ((((66 * (r) + 129 * (g) + 25 * (b) + 128) >> 8) + 16))
+// Chroma of the sums of a 2x2 block, 10 bit fixed point with the average folded in
+#define PIXELS_U(r, g, b) ((((-38 * (r) - 74 * (g) + 112 * (b) + 512) >> 10) + 128))
+#define PIXELS_V(r, g, b) ((((112 * (r) - 94 * (g) - 18 * (b) + 512) >> 10) + 128))
+
+// Row kernels, the SIMD ones convert the bulk of a row and hand the tail to the scalar ones
+struct PixelsKernels {
+    const char* name;
+    void (*rowRGBA)(const uint8_t* src, uint8_t* dst, int width);
+    void (*rowY)(const uint8_t* src, uint8_t* dst, int width);
+    // U and V of a row pair, step is 1 for the I420 planes and 2 for the NV12 interleave
+    void (*rowsUV)(const uint8_t* row0, const uint8_t* row1, uint8_t* u, uint8_t* v, int step, int width);
+};
+
+static void PixelsRowRGBAScalar(const uint8_t* src, uint8_t* dst, int width) {
+    for (int x = 0; x < width; x++) {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+        dst[3] = 255;
+        src += 4;
+        dst += 4;
+    }
+}
+
+static void PixelsRowYScalar(const uint8_t* src, uint8_t* dst, int width) {
+    for (int x = 0; x < width; x++) {
+        dst[x] = (uint8_t)PIXELS_Y(src[2], src[1], src[0]);
+        src += 4;
+    }
+}
+
+static void PixelsRowsUVScalar(const uint8_t* row0, const uint8_t* row1, uint8_t* u, uint8_t* v, int step, int width) {
+    for (int x = 0; x < width; x += 2) {
+        // The last column of an odd width counts twice
+        int next = x + 1 < width ? 4 : 0;
+        const uint8_t* a = row0 + x * 4;
+        const uint8_t* b = row1 + x * 4;
+        int bs = a[0] + a[next] + b[0] + b[next];
+        int gs = a[1] + a[next + 1] + b[1] + b[next + 1];
+        int rs = a[2] + a[next + 2] + b[2] + b[next + 2];
+        *u = (uint8_t)PIXELS_U(rs, gs, bs);
+        *v = (uint8_t)PIXELS_V(rs, gs, bs);
+        u += step;
+        v += step;
+    }
+}
+
+#if defined(PIXELS_X86)
+    // Sum the int32 pairs of two madd results, [a0+a1, a2+a3, b0+b1, b2+b3]
+    __attribute__((target("sse2")))
+    static inline __m128i PixelsPairSumSSE2(__m128i a, __m128i b) {
+        a = _mm_add_epi32(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)));
+        b = _mm_add_epi32(b, _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_unpacklo_epi64(_mm_shuffle_epi32(a, _MM_SHUFFLE(3, 1, 2, 0)), _mm_shuffle_epi32(b, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+
+    // Y of 4 pixels as int32
+    __attribute__((target("sse2")))
+    static inline __m128i PixelsLumaSSE2(__m128i px) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i coef = _mm_setr_epi16(25, 129, 66, 0, 25, 129, 66, 0);
+        __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(px, zero), coef);
+        __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(px, zero), coef);
+        __m128i y = PixelsPairSumSSE2(lo, hi);
+        return _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(y, _mm_set1_epi32(128)), 8), _mm_set1_epi32(16));
+    }
+
+    // Channel sums of the two 2x2 blocks in 4 pixels of each row, [B G R X B G R X] as int16
+    __attribute__((target("sse2")))
+    static inline __m128i PixelsBlocksSSE2(__m128i a, __m128i b) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+        __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+        lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+        hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+        return _mm_unpacklo_epi64(lo, hi);
+    }
+
+    __attribute__((target("sse2")))
+    static void PixelsRowRGBASSE2(const uint8_t* src, uint8_t* dst, int width) {
+        const __m128i byte = _mm_set1_epi32(0xFF);
+        const __m128i green = _mm_set1_epi32(0xFF00);
+        const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+        int x = 0;
+        for (; x + 4 <= width; x += 4) {
+            __m128i px = _mm_loadu_si128((const __m128i*)(src + x * 4));
+            __m128i rb = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(px, byte), 16), _mm_and_si128(_mm_srli_epi32(px, 16), byte));
+            __m128i out = _mm_or_si128(_mm_or_si128(rb, _mm_and_si128(px, green)), alpha);
+            _mm_storeu_si128((__m128i*)(dst + x * 4), out);
+        }
+        PixelsRowRGBAScalar(src + x * 4, dst + x * 4, width - x);
+    }
+
+    __attribute__((target("sse2")))
+    static void PixelsRowYSSE2(const uint8_t* src, uint8_t* dst, int width) {
+        int x = 0;
+        for (; x + 8 <= width; x += 8) {
+            __m128i y0 = PixelsLumaSSE2(_mm_loadu_si128((const __m128i*)(src + x * 4)));
+            __m128i y1 = PixelsLumaSSE2(_mm_loadu_si128((const __m128i*)(src + x * 4 + 16)));
+            __m128i y = _mm_packs_epi32(y0, y1);
+            _mm_storel_epi64((__m128i*)(dst + x), _mm_packus_epi16(y, y));
+        }
+        PixelsRowYScalar(src + x * 4, dst + x, width - x);
+    }
+
+    __attribute__((target("sse2")))
+    static void PixelsRowsUVSSE2(const uint8_t* row0, const uint8_t* row1, uint8_t* u, uint8_t* v, int step, int width) {
+        const __m128i coefU = _mm_setr_epi16(112, -74, -38, 0, 112, -74, -38, 0);
+        const __m128i coefV = _mm_setr_epi16(-18, -94, 112, 0, -18, -94, 112, 0);
+        const __m128i round = _mm_set1_epi32(512);
+        const __m128i offset = _mm_set1_epi32(128);
+        int x = 0;
+        for (; x + 8 <= width; x += 8) {
+            __m128i blocks01 = PixelsBlocksSSE2(_mm_loadu_si128((const __m128i*)(row0 + x * 4)),
+                _mm_loadu_si128((const __m128i*)(row1 + x * 4)));
+            __m128i blocks23 = PixelsBlocksSSE2(_mm_loadu_si128((const __m128i*)(row0 + x * 4 + 16)),
+                _mm_loadu_si128((const __m128i*)(row1 + x * 4 + 16)));
+            __m128i cu = PixelsPairSumSSE2(_mm_madd_epi16(blocks01, coefU), _mm_madd_epi16(blocks23, coefU));
+            __m128i cv = PixelsPairSumSSE2(_mm_madd_epi16(blocks01, coefV), _mm_madd_epi16(blocks23, coefV));
+            cu = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(cu, round), 10), offset);
+            cv = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(cv, round), 10), offset);
+            // [u0..u3 v0..v3] as bytes
+            __m128i uv = _mm_packs_epi32(cu, cv);
+            uv = _mm_packus_epi16(uv, uv);
+            if (step == 2) {
+                _mm_storel_epi64((__m128i*)u, _mm_unpacklo_epi8(uv, _mm_srli_si128(uv, 4)));
+            } else {
+                int32_t planes[2] = {_mm_cvtsi128_si32(uv), _mm_cvtsi128_si32(_mm_srli_si128(uv, 4))};
+                memcpy(u, &planes[0], 4);
+                memcpy(v, &planes[1], 4);
+            }
+            u += 4 * step;
+            v += 4 * step;
+        }
+        PixelsRowsUVScalar(row0 + x * 4, row1 + x * 4, u, v, step, width - x);
+    }
+
+    // The 256 bit versions work per 128 bit lane, the permutes put the lanes back in pixel order
+    __attribute__((target("avx2")))
+    static inline __m256i PixelsPairSumAVX2(__m256i a, __m256i b) {
+        a = _mm256_add_epi32(a, _mm256_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)));
+        b = _mm256_add_epi32(b, _mm256_shuffle_epi32(b, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm256_unpacklo_epi64(_mm256_shuffle_epi32(a, _MM_SHUFFLE(3, 1, 2, 0)), _mm256_shuffle_epi32(b, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+
+    // Y of 8 pixels as int32, in pixel order
+    __attribute__((target("avx2")))
+    static inline __m256i PixelsLumaAVX2(__m256i px) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i coef = _mm256_setr_epi16(25, 129, 66, 0, 25, 129, 66, 0, 25, 129, 66, 0, 25, 129, 66, 0);
+        __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi8(px, zero), coef);
+        __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi8(px, zero), coef);
+        __m256i y = PixelsPairSumAVX2(lo, hi);
+        return _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(y, _mm256_set1_epi32(128)), 8), _mm256_set1_epi32(16));
+    }
+
+    // Channel sums of the four 2x2 blocks in 8 pixels of each row, blocks 0 1 in the low lane and 2 3 in the high
+    __attribute__((target("avx2")))
+    static inline __m256i PixelsBlocksAVX2(__m256i a, __m256i b) {
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero));
+        __m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero));
+        lo = _mm256_add_epi16(lo, _mm256_srli_si256(lo, 8));
+        hi = _mm256_add_epi16(hi, _mm256_srli_si256(hi, 8));
+        return _mm256_unpacklo_epi64(lo, hi);
+    }
+
+    __attribute__((target("avx2")))
+    static void PixelsRowRGBAAVX2(const uint8_t* src, uint8_t* dst, int width) {
+        const __m256i order = _mm256_setr_epi8(2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1,
+            2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1);
+        const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+        int x = 0;
+        for (; x + 8 <= width; x += 8) {
+            __m256i px = _mm256_loadu_si256((const __m256i*)(src + x * 4));
+            _mm256_storeu_si256((__m256i*)(dst + x * 4), _mm256_or_si256(_mm256_shuffle_epi8(px, order), alpha));
+        }
+        PixelsRowRGBASSE2(src + x * 4, dst + x * 4, width - x);
+    }
+
+    __attribute__((target("avx2")))
+    static void PixelsRowYAVX2(const uint8_t* src, uint8_t* dst, int width) {
+        int x = 0;
+        for (; x + 16 <= width; x += 16) {
+            __m256i y0 = PixelsLumaAVX2(_mm256_loadu_si256((const __m256i*)(src + x * 4)));
+            __m256i y1 = PixelsLumaAVX2(_mm256_loadu_si256((const __m256i*)(src + x * 4 + 32)));
+            __m256i y = _mm256_permute4x64_epi64(_mm256_packs_epi32(y0, y1), _MM_SHUFFLE(3, 1, 2, 0));
+            y = _mm256_permute4x64_epi64(_mm256_packus_epi16(y, y), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm_storeu_si128((__m128i*)(dst + x), _mm256_castsi256_si128(y));
+        }
+        PixelsRowYSSE2(src + x * 4, dst + x, width - x);
+    }
+
+    __attribute__((target("avx2")))
+    static void PixelsRowsUVAVX2(const uint8_t* row0, const uint8_t* row1, uint8_t* u, uint8_t* v, int step, int width) {
+        const __m256i coefU = _mm256_setr_epi16(112, -74, -38, 0, 112, -74, -38, 0, 112, -74, -38, 0, 112, -74, -38, 0);
+        const __m256i coefV = _mm256_setr_epi16(-18, -94, 112, 0, -18, -94, 112, 0, -18, -94, 112, 0, -18, -94, 112, 0);
+        const __m256i round = _mm256_set1_epi32(512);
+        const __m256i offset = _mm256_set1_epi32(128);
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        int x = 0;
+        for (; x + 16 <= width; x += 16) {
+            __m256i blocksA = PixelsBlocksAVX2(_mm256_loadu_si256((const __m256i*)(row0 + x * 4)),
+                _mm256_loadu_si256((const __m256i*)(row1 + x * 4)));
+            __m256i blocksB = PixelsBlocksAVX2(_mm256_loadu_si256((const __m256i*)(row0 + x * 4 + 32)),
+                _mm256_loadu_si256((const __m256i*)(row1 + x * 4 + 32)));
+            __m256i cu = PixelsPairSumAVX2(_mm256_madd_epi16(blocksA, coefU), _mm256_madd_epi16(blocksB, coefU));
+            __m256i cv = PixelsPairSumAVX2(_mm256_madd_epi16(blocksA, coefV), _mm256_madd_epi16(blocksB, coefV));
+            cu = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(cu, round), 10), offset);
+            cv = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(cv, round), 10), offset);
+            // u0..u7 in the low lane and v0..v7 in the high lane
+            __m256i uv = _mm256_permutevar8x32_epi32(_mm256_packs_epi32(cu, cv), order);
+            uv = _mm256_packus_epi16(uv, uv);
+            __m128i pu = _mm256_castsi256_si128(uv);
+            __m128i pv = _mm256_extracti128_si256(uv, 1);
+            if (step == 2) {
+                _mm_storeu_si128((__m128i*)u, _mm_unpacklo_epi8(pu, pv));
+            } else {
+                _mm_storel_epi64((__m128i*)u, pu);
+                _mm_storel_epi64((__m128i*)v, pv);
+            }
+            u += 8 * step;
+            v += 8 * step;
+        }
+        PixelsRowsUVSSE2(row0 + x * 4, row1 + x * 4, u, v, step, width - x);
+    }
+#endif
+
+static const PixelsKernels pixelsScalar = {"scalar", PixelsRowRGBAScalar, PixelsRowYScalar, PixelsRowsUVScalar};
+#if defined(PIXELS_X86)
+    static const PixelsKernels pixelsSSE2 = {"sse2", PixelsRowRGBASSE2, PixelsRowYSSE2, PixelsRowsUVSSE2};
+    static const PixelsKernels pixelsAVX2 = {"avx2", PixelsRowRGBAAVX2, PixelsRowYAVX2, PixelsRowsUVAVX2};
+#endif
+
+static const PixelsKernels* PixelsSelect() {
+    static const PixelsKernels* kernels = nullptr;
+    static std::once_flag selected;
+    std::call_once(selected, []() {
+        const char* cap = getenv("EASY_CONTROL_SIMD");
+        kernels = &pixelsScalar;
+        #if defined(PIXELS_X86)
+            bool allowSSE2 = !cap || strcmp(cap, "scalar") != 0;
+            bool allowAVX2 = !cap || (strcmp(cap, "scalar") != 0 && strcmp(cap, "sse2") != 0);
+            __builtin_cpu_init();
+            if (allowAVX2 && __builtin_cpu_supports("avx2")) {
+                kernels = &pixelsAVX2;
+            } else if (allowSSE2 && __builtin_cpu_supports("sse2")) {
+                kernels = &pixelsSSE2;
+            }
+        #else
+            (void)cap;
+        #endif
+    });
+    return kernels;
+}
+
+size_t PixelsSize(PixelFormat format, int width, int height) {
+    size_t pixels = (size_t)width * height;
+    size_t chroma = (size_t)((width + 1) / 2) * ((height + 1) / 2);
+    switch (format) {
+        case PIXEL_FORMAT_I420:
+        case PIXEL_FORMAT_NV12:
+            return pixels + chroma * 2;
+        default:
+            return pixels * 4;
+    }
+}
+
+void PixelsConvert(const uint8_t* src, int stride, int width, int height, PixelFormat format, uint8_t* dst) {
+    const PixelsKernels* kernels = PixelsSelect();
+    if (format == PIXEL_FORMAT_BGRX) {
+        for (int y = 0; y < height; y++) {
+            memcpy(dst + (size_t)y * width * 4, src + (size_t)y * stride, (size_t)width * 4);
+        }
+        return;
+    }
+    if (format == PIXEL_FORMAT_RGBA) {
+        for (int y = 0; y < height; y++) {
+            kernels->rowRGBA(src + (size_t)y * stride, dst + (size_t)y * width * 4, width);
+        }
+        return;
+    }
+
+    for (int y = 0; y < height; y++) {
+        kernels->rowY(src + (size_t)y * stride, dst + (size_t)y * width, width);
+    }
+
+    // The last row of an odd height counts twice
+    int chromaW = (width + 1) / 2;
+    int chromaH = (height + 1) / 2;
+    uint8_t* planes = dst + (size_t)width * height;
+    for (int y = 0; y < chromaH; y++) {
+        const uint8_t* row0 = src + (size_t)y * 2 * stride;
+        const uint8_t* row1 = y * 2 + 1 < height ? row0 + stride : row0;
+        if (format == PIXEL_FORMAT_NV12) {
+            uint8_t* uv = planes + (size_t)y * chromaW * 2;
+            kernels->rowsUV(row0, row1, uv, uv + 1, 2, width);
+        } else {
+            uint8_t* u = planes + (size_t)y * chromaW;
+            kernels->rowsUV(row0, row1, u, u + (size_t)chromaW * chromaH, 1, width);
+        }
+    }
+}
+
+const char* PixelsKernel() {
+    return PixelsSelect()->name;
+}
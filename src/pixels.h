@@ -0,0 +1,26 @@
+#pragma once
+#ifndef PIXELS_H
+#define PIXELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Pixel formats of captured frames, the rows and planes of a frame are packed
+enum PixelFormat {
+    PIXEL_FORMAT_BGRX = 0,      // X11 ZPixmap, 4 bytes per pixel
+    PIXEL_FORMAT_RGBA = 1,      // 4 bytes per pixel, alpha is 255
+    PIXEL_FORMAT_I420 = 2,      // Y plane, then the U and the V plane at half width and height
+    PIXEL_FORMAT_NV12 = 3       // Y plane, then one interleaved UV plane at half width and height
+};
+
+// Bytes of a width x height frame in the format
+size_t PixelsSize(PixelFormat format, int width, int height);
+
+// Convert BGRX rows stride bytes apart into a frame of the format, YUV is BT.601 limited range
+// The kernels are picked by the CPU features on first use, EASY_CONTROL_SIMD=scalar|sse2|avx2 caps them
+void PixelsConvert(const uint8_t* src, int stride, int width, int height, PixelFormat format, uint8_t* dst);
+
+// Instruction set of the kernels in use, "avx2", "sse2" or "scalar"
+const char* PixelsKernel();
+
+#endif
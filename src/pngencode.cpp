@@ -0,0 +1,315 @@
+#include "pngencode.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+#include <zlib.h>
+
+// Deflate window, a stripe starts with the end of the one before it as its dictionary
+#define PNG_WINDOW 32768
+
+// Stripes of one PngEncode phase, claimed one at a time by the caller and the helper threads
+struct PngJob {
+    int next = 0;           // next stripe to claim
+    int count = 0;
+    int done = 0;
+    std::function<void(int)> run;
+    std::condition_variable finished;
+};
+
+// Helper threads, started by the first PngEncode, shared by every encoding in flight
+static std::mutex pngMutex;
+static std::condition_variable pngWake;
+static std::deque<PngJob*> pngJobs;
+static std::vector<std::thread> pngThreads;
+static bool pngStopping = false;
+
+// Claim the next stripe of the front job, -1 if there is none, pngMutex is held
+static int PngClaimLocked(PngJob*& job) {
+    if (pngJobs.empty()) {
+        return -1;
+    }
+    job = pngJobs.front();
+    int index = job->next++;
+    if (job->next >= job->count) {
+        pngJobs.pop_front();
+    }
+    return index;
+}
+
+// Run a claimed stripe and count it, the job may be gone once done reaches count
+static void PngRunClaimed(PngJob* job, int index) {
+    job->run(index);
+    std::lock_guard<std::mutex> lock(pngMutex);
+    if (++job->done == job->count) {
+        job->finished.notify_all();
+    }
+}
+
+static void PngHelperLoop() {
+    std::unique_lock<std::mutex> lock(pngMutex);
+    for (;;) {
+        pngWake.wait(lock, []() { return pngStopping || !pngJobs.empty(); });
+        if (pngStopping) {
+            return;
+        }
+        PngJob* job;
+        int index = PngClaimLocked(job);
+        lock.unlock();
+        PngRunClaimed(job, index);
+        lock.lock();
+    }
+}
+
+// Run count stripes on the helper threads and the calling thread, returns when all are done
+static void PngRunParallel(int count, const std::function<void(int)>& run) {
+    PngJob job;
+    job.count = count;
+    job.run = run;
+
+    std::unique_lock<std::mutex> lock(pngMutex);
+    if (pngThreads.empty() && !pngStopping) {
+        for (int i = 1; i < PngDefaultThreads(); i++) {
+            pngThreads.emplace_back(PngHelperLoop);
+        }
+    }
+    pngJobs.push_back(&job);
+    pngWake.notify_all();
+
+    // Work on the own job until its stripes are all claimed, then wait for the helpers
+    while (job.next < job.count) {
+        PngJob* claimed;
+        int index = PngClaimLocked(claimed);
+        lock.unlock();
+        PngRunClaimed(claimed, index);
+        lock.lock();
+    }
+    job.finished.wait(lock, [&job]() { return job.done == job.count; });
+}
+
+int PngDefaultThreads() {
+    int threads = (int)std::thread::hardware_concurrency();
+    return threads < 1 ? 1 : threads > 16 ? 16 : threads;
+}
+
+void PngEncodeStop() {
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(pngMutex);
+        pngStopping = true;
+        threads.swap(pngThreads);
+        pngWake.notify_all();
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    std::lock_guard<std::mutex> lock(pngMutex);
+    pngStopping = false;
+}
+
+// Signed magnitude of a filtered byte, the sum over a row picks its filter
+static inline int PngCost(uint8_t value) {
+    return value < 128 ? value : 256 - value;
+}
+
+static inline uint8_t PngPaeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = abs(p - a);
+    int pb = abs(p - b);
+    int pc = abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return (uint8_t)a;
+    }
+    return (uint8_t)(pb <= pc ? b : c);
+}
+
+static void PngRowRGB(const uint8_t* src, uint8_t* dst, int width) {
+    for (int x = 0; x < width; x++) {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+        src += 4;
+        dst += 3;
+    }
+}
+
+// Filter a row with each of the five PNG filters and write the one with the lowest cost after its filter byte
+// Level 0 stores the rows unfiltered
+static void PngFilterRow(const uint8_t* row, const uint8_t* prev, int length, int level, uint8_t* scratch, uint8_t* out) {
+    if (level == 0) {
+        out[0] = 0;
+        memcpy(out + 1, row, length);
+        return;
+    }
+
+    uint8_t* filtered[5] = {nullptr, scratch, scratch + length, scratch + length * 2, scratch + length * 3};
+    int costs[5] = {0, 0, 0, 0, 0};
+    for (int i = 0; i < length; i++) {
+        int a = i >= 3 ? row[i - 3] : 0;
+        int b = prev[i];
+        int c = i >= 3 ? prev[i - 3] : 0;
+        uint8_t sub = (uint8_t)(row[i] - a);
+        uint8_t up = (uint8_t)(row[i] - b);
+        uint8_t average = (uint8_t)(row[i] - ((a + b) >> 1));
+        uint8_t paeth = (uint8_t)(row[i] - PngPaeth(a, b, c));
+        filtered[1][i] = sub;
+        filtered[2][i] = up;
+        filtered[3][i] = average;
+        filtered[4][i] = paeth;
+        costs[0] += PngCost(row[i]);
+        costs[1] += PngCost(sub);
+        costs[2] += PngCost(up);
+        costs[3] += PngCost(average);
+        costs[4] += PngCost(paeth);
+    }
+
+    int best = 0;
+    for (int i = 1; i < 5; i++) {
+        if (costs[i] < costs[best]) {
+            best = i;
+        }
+    }
+    out[0] = (uint8_t)best;
+    memcpy(out + 1, best == 0 ? row : filtered[best], length);
+}
+
+static void PngPut32(std::vector<uint8_t>& png, uint32_t value) {
+    uint8_t bytes[4] = {(uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value};
+    png.insert(png.end(), bytes, bytes + 4);
+}
+
+// Append a chunk, the data is the concatenation of the parts
+static void PngPutChunk(std::vector<uint8_t>& png, const char* type, const std::vector<std::pair<const uint8_t*, size_t>>& parts) {
+    size_t length = 0;
+    for (const auto& part : parts) {
+        length += part.second;
+    }
+    PngPut32(png, (uint32_t)length);
+    size_t start = png.size();
+    png.insert(png.end(), type, type + 4);
+    for (const auto& part : parts) {
+        png.insert(png.end(), part.first, part.first + part.second);
+    }
+    uint32_t crc = crc32(0L, png.data() + start, (uInt)(png.size() - start));
+    PngPut32(png, crc);
+}
+
+bool PngEncode(const uint8_t* pixels, int stride, int width, int height, int level, int threads, std::vector<uint8_t>& png) {
+    // zlib counts the input of a call in 32 bits
+    size_t rowLength = (size_t)width * 3;
+    size_t filteredRow = rowLength + 1;
+    if (width <= 0 || height <= 0 || level < 0 || level > 9 || filteredRow * height > INT32_MAX) {
+        return false;
+    }
+
+    // Filtered rows of the whole image, a filter byte and the RGB bytes each
+    std::vector<uint8_t> filtered(filteredRow * height);
+
+    // Small stripes cost compression, keep at least 16 rows in each
+    int stripes = threads < 1 ? 1 : threads > PNG_MAX_THREADS ? PNG_MAX_THREADS : threads;
+    if (stripes > height / 16) {
+        stripes = height / 16 > 0 ? height / 16 : 1;
+    }
+    auto stripeRow = [height, stripes](int stripe) {
+        return (int)((int64_t)height * stripe / stripes);
+    };
+
+    // Filter the stripes, the row before a stripe comes straight from the pixels
+    std::vector<uLong> adlers(stripes);
+    PngRunParallel(stripes, [&](int stripe) {
+        std::vector<uint8_t> rows(rowLength * 2, 0);
+        std::vector<uint8_t> scratch(rowLength * 4);
+        uint8_t* row = rows.data();
+        uint8_t* prev = rows.data() + rowLength;
+        int first = stripeRow(stripe);
+        int last = stripeRow(stripe + 1);
+        if (first > 0) {
+            PngRowRGB(pixels + (size_t)(first - 1) * stride, prev, width);
+        }
+        for (int y = first; y < last; y++) {
+            PngRowRGB(pixels + (size_t)y * stride, row, width);
+            PngFilterRow(row, prev, (int)rowLength, level, scratch.data(), filtered.data() + filteredRow * y);
+            uint8_t* swap = prev;
+            prev = row;
+            row = swap;
+        }
+        adlers[stripe] = adler32(1L, filtered.data() + filteredRow * first, (uInt)(filteredRow * (last - first)));
+    });
+
+    // Deflate the stripes as raw streams ending on a byte boundary, only the last one is final
+    std::vector<std::vector<uint8_t>> deflated(stripes);
+    std::vector<char> failed(stripes, 0);
+    PngRunParallel(stripes, [&](int stripe) {
+        size_t start = filteredRow * stripeRow(stripe);
+        size_t length = filteredRow * stripeRow(stripe + 1) - start;
+        bool isLast = stripe == stripes - 1;
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            failed[stripe] = 1;
+            return;
+        }
+        if (start > 0) {
+            size_t dictionary = start < PNG_WINDOW ? start : PNG_WINDOW;
+            deflateSetDictionary(&stream, filtered.data() + start - dictionary, (uInt)dictionary);
+        }
+        std::vector<uint8_t>& out = deflated[stripe];
+        out.resize(deflateBound(&stream, (uLong)length) + 16);
+        stream.next_in = filtered.data() + start;
+        stream.avail_in = (uInt)length;
+        stream.next_out = out.data();
+        stream.avail_out = (uInt)out.size();
+        int status = deflate(&stream, isLast ? Z_FINISH : Z_SYNC_FLUSH);
+        if (status != (isLast ? Z_STREAM_END : Z_OK) || stream.avail_in != 0) {
+            failed[stripe] = 1;
+        }
+        out.resize(out.size() - stream.avail_out);
+        deflateEnd(&stream);
+    });
+
+    uLong adler = adlers[0];
+    for (int i = 0; i < stripes; i++) {
+        if (failed[i]) {
+            return false;
+        }
+        if (i > 0) {
+            adler = adler32_combine(adler, adlers[i], (z_off_t)(filteredRow * (stripeRow(i + 1) - stripeRow(i))));
+        }
+    }
+
+    // One IDAT per stripe, the first starts with the zlib header and the last ends with the Adler-32
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    const uint8_t header[2] = {0x78, (uint8_t)(level < 2 ? 0x01 : level < 6 ? 0x5E : level == 6 ? 0x9C : 0xDA)};
+    const uint8_t trailer[4] = {(uint8_t)(adler >> 24), (uint8_t)(adler >> 16), (uint8_t)(adler >> 8), (uint8_t)adler};
+    uint8_t ihdr[13] = {0, 0, 0, 0, 0, 0, 0, 0, 8, 2, 0, 0, 0};    // 8 bit RGB, deflate, adaptive filters, no interlace
+    for (int i = 0; i < 4; i++) {
+        ihdr[i] = (uint8_t)(width >> (24 - i * 8));
+        ihdr[4 + i] = (uint8_t)(height >> (24 - i * 8));
+    }
+
+    size_t size = 8 + 25 + 12;
+    for (const std::vector<uint8_t>& out : deflated) {
+        size += out.size() + 12;
+    }
+    png.clear();
+    png.reserve(size + 6);
+    png.insert(png.end(), signature, signature + 8);
+    PngPutChunk(png, "IHDR", {{ihdr, sizeof(ihdr)}});
+    for (int i = 0; i < stripes; i++) {
+        std::vector<std::pair<const uint8_t*, size_t>> parts;
+        if (i == 0) {
+            parts.push_back({header, sizeof(header)});
+        }
+        parts.push_back({deflated[i].data(), deflated[i].size()});
+        if (i == stripes - 1) {
+            parts.push_back({trailer, sizeof(trailer)});
+        }
+        PngPutChunk(png, "IDAT", parts);
+    }
+    PngPutChunk(png, "IEND", {});
+    return true;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#ifndef PNGENCODE_H
+#define PNGENCODE_H
+
+#include <stdint.h>
+#include <vector>
+
+// Upper limit of the threads option, the stripes a frame is split into
+#define PNG_MAX_THREADS 64
+
+// Encode BGRX rows stride bytes apart as an 8 bit RGB PNG with zlib level 0 to 9
+// The rows are filtered and deflated in up to threads stripes in parallel, the calling thread
+// works on the stripes too so the encoding finishes even while the helper threads are stopped
+bool PngEncode(const uint8_t* pixels, int stride, int width, int height, int level, int threads, std::vector<uint8_t>& png);
+
+// Number of threads PngEncode uses by default, the hardware threads up to 16
+int PngDefaultThreads();
+
+// Join the helper threads, the next PngEncode starts them again
+void PngEncodeStop();
+
+#endif
@@ -2,6 +2,11 @@
 
 #include <vector>
 
+#if defined(IS_LINUX)
+    #include "pixels.h"
+    #include "pngencode.h"
+#endif
+
 #if defined(IS_WINDOWS)
     #include <shellscalingapi.h>
     #pragma comment(lib, "Shcore.lib")
@@ -10,24 +15,31 @@
     #include <CoreGraphics/CoreGraphics.h>
 #elif defined(IS_LINUX)
     #include <stdlib.h>
+    #include <string.h>
     #include <cmath>
+    #include <time.h>
+    #include <thread>
+    #include <mutex>
+    #include <atomic>
+    #include <sys/ipc.h>
+    #include <sys/shm.h>
     #include <X11/Xlib.h>
+    #include <X11/Xutil.h>
+    #include <X11/extensions/XShm.h>
+    #include <X11/extensions/Xdamage.h>
     #include <X11/extensions/Xrandr.h>
     #include <X11/extensions/XTest.h>
     #include <X11/extensions/Xfixes.h>
-
-    // Helper function to get the main X11 display
-    // Returns a singleton Display* connection
-    inline Display* XGetMainDisplay() {
-        static Display* display = nullptr;
-        if (display == nullptr) {
-            display = XOpenDisplay(nullptr);
-        }
-        return display;
-    }
 #endif
 
 
+// Constructors of the createSession() and startStream() objects
+static Napi::FunctionReference* sessionConstructor = nullptr;
+static Napi::FunctionReference* streamConstructor = nullptr;
+
+// Upper limit of the startStream() slots option
+#define STREAM_MAX_SLOTS 16
+
 // helper function to list screens
 #if defined(IS_WINDOWS)
 // Structure to hold screen information during enumeration
@@ -250,9 +262,1388 @@ Napi::Array IScreen::list(const Napi::CallbackInfo& info) {
     return result;
 }
 
+#if defined(IS_LINUX)
+// Current size of the root window, DisplayWidth and DisplayHeight keep the size of the connection
+// setup because nothing here calls XRRUpdateConfiguration
+static bool ScreenDesktopSize(Display* display, int& width, int& height) {
+    Window root;
+    int x, y;
+    unsigned int rootWidth, rootHeight, border, depth;
+    if (!XGetGeometry(display, DefaultRootWindow(display), &root, &x, &y, &rootWidth, &rootHeight, &border, &depth)) {
+        return false;
+    }
+    width = (int)rootWidth;
+    height = (int)rootHeight;
+    return true;
+}
+
+// Read the optional {x, y, width, height} capture region, the default is the whole desktop
+// Throws and returns false if the region is not inside the desktop as it is now
+static bool ScreenRegion(Napi::Env env, Napi::Value options, Display* display, int& x, int& y, int& width, int& height) {
+    int desktopWidth, desktopHeight;
+    if (!ScreenDesktopSize(display, desktopWidth, desktopHeight)) {
+        Napi::Error::New(env, "Failed to read the desktop size").ThrowAsJavaScriptException();
+        return false;
+    }
+    x = 0;
+    y = 0;
+    width = desktopWidth;
+    height = desktopHeight;
+    if (options.IsEmpty() || options.IsUndefined()) {
+        return true;
+    }
+    if (!options.IsObject()) {
+        Napi::TypeError::New(env, "Expected region object").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    Napi::Object region = options.As<Napi::Object>();
+    const char* names[4] = {"x", "y", "width", "height"};
+    int* values[4] = {&x, &y, &width, &height};
+    for (int i = 0; i < 4; i++) {
+        Napi::Value value = region.Get(names[i]);
+        if (value.IsUndefined()) {
+            continue;
+        }
+        if (!value.IsNumber()) {
+            Napi::TypeError::New(env, std::string("Expected number ") + names[i]).ThrowAsJavaScriptException();
+            return false;
+        }
+        *values[i] = value.As<Napi::Number>().Int32Value();
+    }
+    // Width and height left out reach to the edge of the desktop
+    if (region.Get("width").IsUndefined()) {
+        width = desktopWidth - x;
+    }
+    if (region.Get("height").IsUndefined()) {
+        height = desktopHeight - y;
+    }
+    if (x < 0 || y < 0 || width <= 0 || height <= 0 || width > desktopWidth - x || height > desktopHeight - y) {
+        Napi::RangeError::New(env, "Region out of the desktop").ThrowAsJavaScriptException();
+        return false;
+    }
+    return true;
+}
+
+// One MIT-SHM segment attached to the X server, lent to JS as the memory of an external ArrayBuffer
+struct ShmSegment {
+    Display* display;
+    XShmSegmentInfo info;
+    size_t size;
+    XImage* image;      // image of the last captured size, its data is the segment
+};
+
+// Idle segments, capture() takes one and the ArrayBuffer finalizer gives it back
+#define SHM_POOL_IDLE 4
+static std::vector<ShmSegment*> shmPool;
+static bool shmPoolClosed = false;
+
+// Trap the X errors of the attach and get image requests instead of the default exit
+// The handler is process-wide, so it is installed once and only claims the errors of the
+// requests sent inside an active trap, every other error goes on to the handler that was there before
+struct ScreenErrorTrap {
+    Display* display;
+    unsigned long serial;       // first request of the trapped section
+    bool isFailed;
+};
+static std::mutex screenTrapMutex;
+static std::vector<ScreenErrorTrap*> screenTraps;
+static XErrorHandler screenPreviousErrorHandler = nullptr;
+
+static int ScreenErrorHandler(Display* display, XErrorEvent* event) {
+    {
+        std::lock_guard<std::mutex> lock(screenTrapMutex);
+        for (ScreenErrorTrap* trap : screenTraps) {
+            if (trap->display == display && event->serial >= trap->serial) {
+                trap->isFailed = true;
+                return 0;
+            }
+        }
+    }
+    if (screenPreviousErrorHandler != nullptr) {
+        return screenPreviousErrorHandler(display, event);
+    }
+    return 0;
+}
+
+// The display stays locked until ScreenTrapEnd, so no other thread's request falls inside the trap
+static void ScreenTrapBegin(Display* display, ScreenErrorTrap& trap) {
+    static std::once_flag errorHandlerInit;
+    std::call_once(errorHandlerInit, []() {
+        screenPreviousErrorHandler = XSetErrorHandler(ScreenErrorHandler);
+    });
+
+    XLockDisplay(display);
+    trap.display = display;
+    trap.serial = NextRequest(display);
+    trap.isFailed = false;
+    std::lock_guard<std::mutex> lock(screenTrapMutex);
+    screenTraps.push_back(&trap);
+}
+
+// False if a trapped request failed, errors of requests without a reply need an XSync before
+static bool ScreenTrapEnd(ScreenErrorTrap& trap) {
+    {
+        std::lock_guard<std::mutex> lock(screenTrapMutex);
+        for (size_t i = 0; i < screenTraps.size(); i++) {
+            if (screenTraps[i] == &trap) {
+                screenTraps[i] = screenTraps.back();
+                screenTraps.pop_back();
+                break;
+            }
+        }
+    }
+    XUnlockDisplay(trap.display);
+    return !trap.isFailed;
+}
+
+// XShmGetImage of the root window, false instead of the exit on an X error
+static bool ScreenShmGetImage(Display* display, XImage* image, int x, int y) {
+    ScreenErrorTrap trap;
+    ScreenTrapBegin(display, trap);
+    Status status = XShmGetImage(display, DefaultRootWindow(display), image, x, y, AllPlanes);
+    return ScreenTrapEnd(trap) && status;
+}
+
+// XGetImage of the root window, nullptr instead of the exit on an X error
+static XImage* ScreenGetImage(Display* display, int x, int y, int width, int height) {
+    ScreenErrorTrap trap;
+    ScreenTrapBegin(display, trap);
+    XImage* image = XGetImage(display, DefaultRootWindow(display), x, y, width, height, AllPlanes, ZPixmap);
+    if (!ScreenTrapEnd(trap) && image != nullptr) {
+        XDestroyImage(image);
+        image = nullptr;
+    }
+    return image;
+}
+
+static void ShmSegmentDestroy(ShmSegment* segment) {
+    // The attachment died with the connection if the display broke or was reopened since
+    // Peek only, finalizers and the cleanup hook must not open a new connection
+    if (segment->display != nullptr && segment->display == XPeekMainDisplay()) {
+        XShmDetach(segment->display, &segment->info);
+    }
+    if (segment->image != nullptr) {
+        segment->image->data = nullptr;
+        XDestroyImage(segment->image);
+    }
+    shmdt(segment->info.shmaddr);
+    delete segment;
+}
+
+static ShmSegment* ShmSegmentCreate(Display* display, size_t size) {
+    ShmSegment* segment = new ShmSegment();
+    segment->display = display;
+    segment->size = size;
+    segment->image = nullptr;
+    segment->info.shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+    if (segment->info.shmid < 0) {
+        delete segment;
+        return nullptr;
+    }
+    segment->info.shmaddr = (char*)shmat(segment->info.shmid, nullptr, 0);
+    if (segment->info.shmaddr == (char*)-1) {
+        shmctl(segment->info.shmid, IPC_RMID, nullptr);
+        delete segment;
+        return nullptr;
+    }
+    segment->info.readOnly = False;
+
+    ScreenErrorTrap trap;
+    ScreenTrapBegin(display, trap);
+    Status status = XShmAttach(display, &segment->info);
+    XSync(display, False);
+    bool isAttached = ScreenTrapEnd(trap) && status;
+
+    // Removed now, the kernel frees it once both sides detached, even after a crash
+    shmctl(segment->info.shmid, IPC_RMID, nullptr);
+    if (!isAttached) {
+        shmdt(segment->info.shmaddr);
+        delete segment;
+        return nullptr;
+    }
+    return segment;
+}
+
+// An idle segment of at least size bytes, or a new one
+static ShmSegment* ShmSegmentTake(Display* display, size_t size) {
+    for (size_t i = 0; i < shmPool.size(); i++) {
+        ShmSegment* segment = shmPool[i];
+        if (segment->display != display) {
+            // Attached to a closed connection
+            shmPool[i] = shmPool.back();
+            shmPool.pop_back();
+            ShmSegmentDestroy(segment);
+            i--;
+            continue;
+        }
+        if (segment->size >= size) {
+            shmPool[i] = shmPool.back();
+            shmPool.pop_back();
+            return segment;
+        }
+    }
+    return ShmSegmentCreate(display, size);
+}
+
+static void ShmSegmentGive(ShmSegment* segment) {
+    if (shmPoolClosed || shmPool.size() >= SHM_POOL_IDLE) {
+        ShmSegmentDestroy(segment);
+        return;
+    }
+    shmPool.push_back(segment);
+}
+
+// Capture the region into the segment, reusing its XImage while the size stays the same
+static XImage* ShmSegmentCapture(ShmSegment* segment, int x, int y, int width, int height) {
+    Display* display = segment->display;
+    XImage* image = segment->image;
+    if (image == nullptr || image->width != width || image->height != height) {
+        if (image != nullptr) {
+            image->data = nullptr;
+            XDestroyImage(image);
+        }
+        int screen = DefaultScreen(display);
+        image = XShmCreateImage(display, DefaultVisual(display, screen), DefaultDepth(display, screen),
+            ZPixmap, segment->info.shmaddr, &segment->info, width, height);
+        segment->image = image;
+        if (image == nullptr) {
+            return nullptr;
+        }
+    }
+    if ((size_t)image->bytes_per_line * height > segment->size || !ScreenShmGetImage(display, image, x, y)) {
+        return nullptr;
+    }
+    return image;
+}
+
+// Capture several rects packed one after the other, XShmGetImage writes at the offset of image->data
+static bool ShmSegmentCaptureRects(ShmSegment* segment, const XRectangle* rects, int count, uint32_t* offsets, uint32_t* strides) {
+    if (count == 1) {
+        XImage* image = ShmSegmentCapture(segment, rects[0].x, rects[0].y, rects[0].width, rects[0].height);
+        if (image == nullptr || image->bits_per_pixel != 32) {
+            return false;
+        }
+        offsets[0] = 0;
+        strides[0] = image->bytes_per_line;
+        return true;
+    }
+
+    Display* display = segment->display;
+    int screen = DefaultScreen(display);
+    size_t offset = 0;
+    for (int i = 0; i < count; i++) {
+        XImage* image = XShmCreateImage(display, DefaultVisual(display, screen), DefaultDepth(display, screen),
+            ZPixmap, segment->info.shmaddr + offset, &segment->info, rects[i].width, rects[i].height);
+        if (image == nullptr) {
+            return false;
+        }
+        size_t length = (size_t)image->bytes_per_line * rects[i].height;
+        bool isCaptured = image->bits_per_pixel == 32 && offset + length <= segment->size &&
+            ScreenShmGetImage(display, image, rects[i].x, rects[i].y);
+        offsets[i] = (uint32_t)offset;
+        strides[i] = image->bytes_per_line;
+        image->data = nullptr;
+        XDestroyImage(image);
+        if (!isCaptured) {
+            return false;
+        }
+        offset += length;
+    }
+    return true;
+}
+
+// Capture the rects into one ArrayBuffer of BGRX rows, the pixels of rect i start at offsets[i]
+// Throws and returns an empty value on failure
+static Napi::Value ScreenCaptureRects(Napi::Env env, Display* display, const XRectangle* rects, int count, uint32_t* offsets, uint32_t* strides) {
+    size_t length = 0;
+    for (int i = 0; i < count; i++) {
+        length += (size_t)rects[i].width * rects[i].height * 4;
+    }
+
+    // Without MIT-SHM (remote X server) the images come through the socket and are copied
+    ShmSegment* segment = nullptr;
+    if (XShmQueryExtension(display)) {
+        segment = ShmSegmentTake(display, length);
+    }
+    if (segment == nullptr) {
+        Napi::ArrayBuffer data = Napi::ArrayBuffer::New(env, length);
+        size_t offset = 0;
+        for (int i = 0; i < count; i++) {
+            XImage* image = ScreenGetImage(display, rects[i].x, rects[i].y, rects[i].width, rects[i].height);
+            size_t imageLength = image != nullptr ? (size_t)image->bytes_per_line * rects[i].height : 0;
+            if (image == nullptr || image->bits_per_pixel != 32 || offset + imageLength > length) {
+                if (image != nullptr) {
+                    XDestroyImage(image);
+                }
+                Napi::Error::New(env, "Failed to capture the screen").ThrowAsJavaScriptException();
+                return Napi::Value();
+            }
+            memcpy((uint8_t*)data.Data() + offset, image->data, imageLength);
+            offsets[i] = (uint32_t)offset;
+            strides[i] = image->bytes_per_line;
+            offset += imageLength;
+            XDestroyImage(image);
+        }
+        return data;
+    }
+
+    if (!ShmSegmentCaptureRects(segment, rects, count, offsets, strides)) {
+        ShmSegmentGive(segment);
+        Napi::Error::New(env, "Failed to capture the screen").ThrowAsJavaScriptException();
+        return Napi::Value();
+    }
+
+    // The segment goes back to the pool when the ArrayBuffer is collected
+    napi_value data;
+    napi_status status = napi_create_external_arraybuffer(env, segment->info.shmaddr, length,
+        [](napi_env env, void* data, void* hint) {
+            ShmSegmentGive((ShmSegment*)hint);
+        }, segment, &data);
+    if (status != napi_ok) {
+        // Runtimes with the V8 sandbox allow no external memory, copy it instead
+        Napi::ArrayBuffer copy = Napi::ArrayBuffer::New(env, length);
+        memcpy(copy.Data(), segment->info.shmaddr, length);
+        ShmSegmentGive(segment);
+        return copy;
+    }
+    return Napi::Value(env, data);
+}
+
+// Read the format option of capture() and convert(), the default is the captured BGRX
+// Throws and returns false for an unknown name
+static bool ScreenPixelFormat(Napi::Env env, Napi::Value value, PixelFormat& format) {
+    format = PIXEL_FORMAT_BGRX;
+    if (value.IsEmpty() || value.IsUndefined()) {
+        return true;
+    }
+    if (!value.IsString()) {
+        Napi::TypeError::New(env, "Expected string format").ThrowAsJavaScriptException();
+        return false;
+    }
+    std::string name = value.As<Napi::String>().Utf8Value();
+    const char* names[4] = {"bgrx", "rgba", "i420", "nv12"};
+    for (int i = 0; i < 4; i++) {
+        if (name == names[i]) {
+            format = (PixelFormat)i;
+            return true;
+        }
+    }
+    Napi::RangeError::New(env, "Unknown format " + name + ", expected bgrx, rgba, i420 or nv12").ThrowAsJavaScriptException();
+    return false;
+}
+
+// Name of a format as given to the format option
+static const char* ScreenPixelFormatName(PixelFormat format) {
+    const char* names[4] = {"bgrx", "rgba", "i420", "nv12"};
+    return names[format];
+}
+
+// Read a {width, height, stride, data} BGRX frame of capture(), a session or a stream
+// Throws and returns false if the rows are not inside the data
+static bool ScreenFrame(Napi::Env env, Napi::Value value, int& width, int& height, int& stride, const uint8_t*& pixels) {
+    if (!value.IsObject()) {
+        Napi::TypeError::New(env, "Expected frame object").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Object frame = value.As<Napi::Object>();
+    Napi::Value frameFormat = frame.Get("format");
+    if (!frameFormat.IsUndefined() && !(frameFormat.IsString() && frameFormat.As<Napi::String>().Utf8Value() == "bgrx")) {
+        Napi::TypeError::New(env, "Expected a bgrx frame").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Value widthValue = frame.Get("width");
+    Napi::Value heightValue = frame.Get("height");
+    Napi::Value strideValue = frame.Get("stride");
+    if (!widthValue.IsNumber() || !heightValue.IsNumber() || !strideValue.IsNumber()) {
+        Napi::TypeError::New(env, "Expected number width, height and stride").ThrowAsJavaScriptException();
+        return false;
+    }
+    width = widthValue.As<Napi::Number>().Int32Value();
+    height = heightValue.As<Napi::Number>().Int32Value();
+    stride = strideValue.As<Napi::Number>().Int32Value();
+
+    // Frames of capture(), sessions and streams hold an ArrayBuffer, a typed array view works too
+    Napi::Value dataValue = frame.Get("data");
+    size_t length;
+    if (dataValue.IsArrayBuffer()) {
+        Napi::ArrayBuffer buffer = dataValue.As<Napi::ArrayBuffer>();
+        pixels = (const uint8_t*)buffer.Data();
+        length = buffer.ByteLength();
+    } else if (dataValue.IsTypedArray()) {
+        Napi::TypedArray view = dataValue.As<Napi::TypedArray>();
+        pixels = (const uint8_t*)view.ArrayBuffer().Data() + view.ByteOffset();
+        length = view.ByteLength();
+    } else {
+        Napi::TypeError::New(env, "Expected ArrayBuffer or TypedArray data").ThrowAsJavaScriptException();
+        return false;
+    }
+    if (width <= 0 || height <= 0 || stride < width * 4 || length < (size_t)stride * (height - 1) + (size_t)width * 4) {
+        Napi::RangeError::New(env, "Frame size out of the data").ThrowAsJavaScriptException();
+        return false;
+    }
+    return true;
+}
+
+// Read the level (zlib 0 to 9, default 6) and threads (1 to PNG_MAX_THREADS) options of the PNG encoding
+// Throws and returns false if one is out of range
+static bool ScreenPNGOptions(Napi::Env env, Napi::Value value, int& level, int& threads) {
+    level = 6;
+    threads = PngDefaultThreads();
+    if (value.IsEmpty() || value.IsUndefined()) {
+        return true;
+    }
+    if (!value.IsObject()) {
+        Napi::TypeError::New(env, "Expected options object").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Object options = value.As<Napi::Object>();
+    Napi::Value levelValue = options.Get("level");
+    if (!levelValue.IsUndefined()) {
+        if (!levelValue.IsNumber()) {
+            Napi::TypeError::New(env, "Expected number level").ThrowAsJavaScriptException();
+            return false;
+        }
+        level = levelValue.As<Napi::Number>().Int32Value();
+        if (level < 0 || level > 9) {
+            Napi::RangeError::New(env, "Level out of range (0-9)").ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    Napi::Value threadsValue = options.Get("threads");
+    if (!threadsValue.IsUndefined()) {
+        if (!threadsValue.IsNumber()) {
+            Napi::TypeError::New(env, "Expected number threads").ThrowAsJavaScriptException();
+            return false;
+        }
+        threads = threadsValue.As<Napi::Number>().Int32Value();
+        if (threads < 1 || threads > PNG_MAX_THREADS) {
+            Napi::RangeError::New(env, "Threads out of range (1-" + std::to_string(PNG_MAX_THREADS) + ")").ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    return true;
+}
+
+// Capture the region into a pooled segment, or through the socket without MIT-SHM
+// Returns a 32 bit image or nullptr, release it with ScreenImageRelease
+static XImage* ScreenImageCapture(Display* display, const XRectangle& rect, ShmSegment*& segment) {
+    segment = nullptr;
+    if (XShmQueryExtension(display)) {
+        segment = ShmSegmentTake(display, (size_t)rect.width * rect.height * 4);
+    }
+    XImage* image;
+    if (segment != nullptr) {
+        image = ShmSegmentCapture(segment, rect.x, rect.y, rect.width, rect.height);
+    } else {
+        image = ScreenGetImage(display, rect.x, rect.y, rect.width, rect.height);
+    }
+    if (image != nullptr && image->bits_per_pixel != 32) {
+        if (segment == nullptr) {
+            XDestroyImage(image);
+        }
+        image = nullptr;
+    }
+    if (image == nullptr && segment != nullptr) {
+        ShmSegmentGive(segment);
+        segment = nullptr;
+    }
+    return image;
+}
+
+// Give the segment of a captured image back to the pool, or free the image without one
+static void ScreenImageRelease(ShmSegment* segment, XImage* image) {
+    if (segment != nullptr) {
+        ShmSegmentGive(segment);
+    } else if (image != nullptr) {
+        XDestroyImage(image);
+    }
+}
+
+// Capture the region and convert it into a new ArrayBuffer of the format, the segment goes straight back to the pool
+// Throws and returns an empty value on failure
+static Napi::Value ScreenCaptureConverted(Napi::Env env, Display* display, const XRectangle& rect, PixelFormat format) {
+    ShmSegment* segment;
+    XImage* image = ScreenImageCapture(display, rect, segment);
+    if (image == nullptr) {
+        Napi::Error::New(env, "Failed to capture the screen").ThrowAsJavaScriptException();
+        return Napi::Value();
+    }
+
+    Napi::ArrayBuffer data = Napi::ArrayBuffer::New(env, PixelsSize(format, rect.width, rect.height));
+    PixelsConvert((const uint8_t*)image->data, image->bytes_per_line, rect.width, rect.height, format, (uint8_t*)data.Data());
+    ScreenImageRelease(segment, image);
+    return data;
+}
+#endif
+
+Napi::Value IScreen::capture(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    #if defined(IS_LINUX)
+        Display* display = XGetMainDisplay();
+        if (display == NULL) {
+            Napi::Error::New(env, "Failed to open the X display").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        int x, y, width, height;
+        if (!ScreenRegion(env, info.Length() > 0 ? info[0] : env.Undefined(), display, x, y, width, height)) {
+            return env.Undefined();
+        }
+
+        PixelFormat format = PIXEL_FORMAT_BGRX;
+        if (info.Length() > 0 && info[0].IsObject() && !ScreenPixelFormat(env, info[0].As<Napi::Object>().Get("format"), format)) {
+            return env.Undefined();
+        }
+
+        // BGRX is lent zero-copy, the other formats are converted into a packed copy
+        XRectangle rect = {(short)x, (short)y, (unsigned short)width, (unsigned short)height};
+        uint32_t offset, stride = width * 4;
+        Napi::Value data;
+        if (format == PIXEL_FORMAT_BGRX) {
+            data = ScreenCaptureRects(env, display, &rect, 1, &offset, &stride);
+        } else {
+            data = ScreenCaptureConverted(env, display, rect, format);
+            stride = format == PIXEL_FORMAT_RGBA ? width * 4 : width;
+        }
+        if (data.IsEmpty()) {
+            return env.Undefined();
+        }
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("width", width);
+        result.Set("height", height);
+        result.Set("stride", stride);
+        result.Set("format", ScreenPixelFormatName(format));
+        result.Set("data", data);
+        return result;
+    #else
+        Napi::Error::New(env, "Screen capture is not supported on this platform").ThrowAsJavaScriptException();
+        return env.Undefined();
+    #endif
+}
+
+
+Napi::Value IScreen::convert(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    #if defined(IS_LINUX)
+        if (info.Length() < 2 || !info[0].IsObject()) {
+            Napi::TypeError::New(env, "Expected frame object and format").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        PixelFormat format;
+        if (!ScreenPixelFormat(env, info[1], format)) {
+            return env.Undefined();
+        }
+
+        int width, height, stride;
+        const uint8_t* pixels;
+        if (!ScreenFrame(env, info[0], width, height, stride, pixels)) {
+            return env.Undefined();
+        }
+
+        Napi::ArrayBuffer data = Napi::ArrayBuffer::New(env, PixelsSize(format, width, height));
+        PixelsConvert(pixels, stride, width, height, format, (uint8_t*)data.Data());
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("width", width);
+        result.Set("height", height);
+        result.Set("stride", format == PIXEL_FORMAT_I420 || format == PIXEL_FORMAT_NV12 ? width : width * 4);
+        result.Set("format", ScreenPixelFormatName(format));
+        result.Set("data", data);
+        return result;
+    #else
+        Napi::Error::New(env, "Pixel conversion is not supported on this platform").ThrowAsJavaScriptException();
+        return env.Undefined();
+    #endif
+}
+
+
+// PNG encoding async implementation
+EncodePNG::EncodePNG(const Napi::Env& env, int width, int height, int level, int threads) : Napi::AsyncWorker{env, "EncodePNG"},
+    m_deferred{env}, m_width{width}, m_height{height}, m_level{level}, m_threads{threads} {}
+
+EncodePNG::~EncodePNG() {
+    #if defined(IS_LINUX)
+        // The worker is deleted on the JS thread, the only user of the segment pool
+        ScreenImageRelease(this->m_segment, this->m_image);
+    #endif
+}
+
+Napi::Promise EncodePNG::GetPromise() {
+    return m_deferred.Promise();
+}
+
+uint8_t* EncodePNG::Allocate() {
+    this->m_copy.resize((size_t)this->m_width * this->m_height * 4);
+    this->m_pixels = this->m_copy.data();
+    this->m_stride = this->m_width * 4;
+    return this->m_copy.data();
+}
+
+#if defined(IS_LINUX)
+void EncodePNG::Adopt(ShmSegment* segment, XImage* image) {
+    this->m_segment = segment;
+    this->m_image = image;
+    this->m_pixels = (const uint8_t*)image->data;
+    this->m_stride = image->bytes_per_line;
+}
+#endif
+
+void EncodePNG::Execute() {
+    #if defined(IS_LINUX)
+        if (!PngEncode(this->m_pixels, this->m_stride, this->m_width, this->m_height, this->m_level, this->m_threads, this->m_png)) {
+            SetError("Failed to encode the PNG");
+        }
+    #endif
+}
+
+void EncodePNG::OnOK() {
+    m_deferred.Resolve(Napi::Buffer<uint8_t>::Copy(Env(), this->m_png.data(), this->m_png.size()));
+}
+
+void EncodePNG::OnError(const Napi::Error& err) {
+    m_deferred.Reject(err.Value());
+}
+
+Napi::Value IScreen::capturePNG(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    #if defined(IS_LINUX)
+        Display* display = XGetMainDisplay();
+        if (display == NULL) {
+            Napi::Error::New(env, "Failed to open the X display").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        int x, y, width, height, level, threads;
+        Napi::Value options = info.Length() > 0 ? info[0] : env.Undefined();
+        if (!ScreenRegion(env, options, display, x, y, width, height) ||
+            !ScreenPNGOptions(env, options, level, threads)) {
+            return env.Undefined();
+        }
+
+        // The capture stays on the JS thread with the shared connection, the worker encodes straight from the segment
+        XRectangle rect = {(short)x, (short)y, (unsigned short)width, (unsigned short)height};
+        ShmSegment* segment;
+        XImage* image = ScreenImageCapture(display, rect, segment);
+        if (image == nullptr) {
+            Napi::Error::New(env, "Failed to capture the screen").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        EncodePNG* worker = new EncodePNG(env, width, height, level, threads);
+        worker->Adopt(segment, image);
+        worker->Queue();
+        return worker->GetPromise();
+    #else
+        Napi::Error::New(env, "Screen capture is not supported on this platform").ThrowAsJavaScriptException();
+        return env.Undefined();
+    #endif
+}
+
+Napi::Value IScreen::encodePNG(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    #if defined(IS_LINUX)
+        int width, height, stride, level, threads;
+        const uint8_t* pixels;
+        if (!ScreenFrame(env, info.Length() > 0 ? info[0] : env.Undefined(), width, height, stride, pixels) ||
+            !ScreenPNGOptions(env, info.Length() > 1 ? info[1] : env.Undefined(), level, threads)) {
+            return env.Undefined();
+        }
+
+        // The frame may change or be detached while the worker runs, it encodes a copy
+        EncodePNG* worker = new EncodePNG(env, width, height, level, threads);
+        uint8_t* copy = worker->Allocate();
+        for (int y = 0; y < height; y++) {
+            memcpy(copy + (size_t)y * width * 4, pixels + (size_t)y * stride, (size_t)width * 4);
+        }
+        worker->Queue();
+        return worker->GetPromise();
+    #else
+        Napi::Error::New(env, "PNG encoding is not supported on this platform").ThrowAsJavaScriptException();
+        return env.Undefined();
+    #endif
+}
+
+
+Napi::Value IScreen::createSession(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Value options = info.Length() > 0 ? info[0] : env.Undefined();
+    Napi::Object session = sessionConstructor->New({options});
+    if (env.IsExceptionPending()) {
+        return env.Undefined();
+    }
+    return session;
+}
+
+ScreenSession::ScreenSession(const Napi::CallbackInfo& info) : Napi::ObjectWrap<ScreenSession>(info) {
+    Napi::Env env = info.Env();
+
+    #if defined(IS_LINUX)
+        Display* display = XGetMainDisplay();
+        if (display == NULL) {
+            Napi::Error::New(env, "Failed to open the X display").ThrowAsJavaScriptException();
+            return;
+        }
+        int x, y, width, height;
+        if (!ScreenRegion(env, info.Length() > 0 ? info[0] : env.Undefined(), display, x, y, width, height)) {
+            return;
+        }
+        if (info.Length() > 0 && info[0].IsObject()) {
+            Napi::Value maxRectsVal = info[0].As<Napi::Object>().Get("maxRects");
+            if (!maxRectsVal.IsUndefined()) {
+                if (!maxRectsVal.IsNumber()) {
+                    Napi::TypeError::New(env, "Expected number maxRects option").ThrowAsJavaScriptException();
+                    return;
+                }
+                this->m_maxRects = maxRectsVal.As<Napi::Number>().Int32Value();
+                if (this->m_maxRects < 1 || this->m_maxRects > 1024) {
+                    Napi::RangeError::New(env, "maxRects out of range (1-1024)").ThrowAsJavaScriptException();
+                    return;
+                }
+            }
+        }
+
+        // Both extensions answer only after the client announced its version
+        int errorBase, major, minor;
+        if (!XDamageQueryExtension(display, &this->m_eventBase, &errorBase) || !XDamageQueryVersion(display, &major, &minor) ||
+            !XFixesQueryVersion(display, &major, &minor)) {
+            Napi::Error::New(env, "X server has no XDamage extension").ThrowAsJavaScriptException();
+            return;
+        }
+
+        // The server collects the damage, next() takes it in one round trip, so the
+        // notify events are only drained. NonEmpty sends one per next() at most.
+        this->m_display = display;
+        this->m_area = {(short)x, (short)y, (unsigned short)width, (unsigned short)height};
+        this->m_damage = XDamageCreate(display, DefaultRootWindow(display), XDamageReportNonEmpty);
+        this->m_region = XFixesCreateRegion(display, nullptr, 0);
+        this->m_bounds = XFixesCreateRegion(display, &this->m_area, 1);
+        XFlush(display);
+    #else
+        Napi::Error::New(env, "Screen sessions are not supported on this platform").ThrowAsJavaScriptException();
+    #endif
+}
+
+ScreenSession::~ScreenSession() {
+    this->Release();
+}
+
+void ScreenSession::Release() {
+    #if defined(IS_LINUX)
+        if (this->m_damage == 0) {
+            return;
+        }
+        // The objects died with the connection if the display broke or was reopened since
+        // Peek only, the destructor runs during GC and must not open a new connection
+        if (this->m_display == XPeekMainDisplay()) {
+            XDamageDestroy(this->m_display, this->m_damage);
+            XFixesDestroyRegion(this->m_display, this->m_region);
+            XFixesDestroyRegion(this->m_display, this->m_bounds);
+            XFlush(this->m_display);
+        }
+        this->m_damage = 0;
+        this->m_region = 0;
+        this->m_bounds = 0;
+        this->m_display = nullptr;
+    #endif
+}
+
+void ScreenSession::Close(const Napi::CallbackInfo& info) {
+    this->Release();
+}
+
+Napi::Value ScreenSession::Next(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    #if defined(IS_LINUX)
+        if (this->m_damage == 0) {
+            Napi::Error::New(env, "Screen session is closed").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        Display* display = XGetMainDisplay();
+        if (display != this->m_display) {
+            this->Release();
+            Napi::Error::New(env, "Screen session lost the X display, create a new one").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        // Move the collected damage into m_region, clipped to the session area
+        this->m_rects.clear();
+        if (this->m_isFirst) {
+            XDamageSubtract(display, this->m_damage, None, None);
+            this->m_rects.push_back(this->m_area);
+            this->m_isFirst = false;
+        } else {
+            XDamageSubtract(display, this->m_damage, None, this->m_region);
+            XFixesIntersectRegion(display, this->m_region, this->m_region, this->m_bounds);
+            int count = 0;
+            XRectangle bounds;
+            XRectangle* rects = XFixesFetchRegionAndBounds(display, this->m_region, &count, &bounds);
+            if (count > this->m_maxRects) {
+                this->m_rects.push_back(bounds);
+            } else if (count > 0) {
+                this->m_rects.assign(rects, rects + count);
+            }
+            if (rects != nullptr) {
+                XFree(rects);
+            }
+        }
+        XEvent event;
+        while (XCheckTypedEvent(display, this->m_eventBase + XDamageNotify, &event)) {
+        }
+
+        Napi::Object result = Napi::Object::New(env);
+        Napi::Array rects = Napi::Array::New(env, this->m_rects.size());
+        result.Set("rects", rects);
+        if (this->m_rects.empty()) {
+            result.Set("data", env.Null());
+            return result;
+        }
+
+        int count = (int)this->m_rects.size();
+        this->m_offsets.resize(count);
+        this->m_strides.resize(count);
+        Napi::Value data = ScreenCaptureRects(env, display, this->m_rects.data(), count, this->m_offsets.data(), this->m_strides.data());
+        if (data.IsEmpty()) {
+            return env.Undefined();
+        }
+        for (int i = 0; i < count; i++) {
+            Napi::Object rect = Napi::Object::New(env);
+            rect.Set("x", this->m_rects[i].x);
+            rect.Set("y", this->m_rects[i].y);
+            rect.Set("width", this->m_rects[i].width);
+            rect.Set("height", this->m_rects[i].height);
+            rect.Set("offset", this->m_offsets[i]);
+            rect.Set("stride", this->m_strides[i]);
+            rects.Set(i, rect);
+        }
+        result.Set("data", data);
+        return result;
+    #else
+        Napi::Error::New(env, "Screen sessions are not supported on this platform").ThrowAsJavaScriptException();
+        return env.Undefined();
+    #endif
+}
+
+Napi::Function ScreenSession::Init(Napi::Env env) {
+    return DefineClass(env, "ScreenSession", {
+        InstanceMethod("next", &ScreenSession::Next),
+        InstanceMethod("close", &ScreenSession::Close)
+    });
+}
+
+
+#if defined(IS_LINUX)
+// Frame slot of a stream, the capture thread fills free slots and JS borrows the ready ones
+enum StreamSlotState {
+    STREAM_SLOT_FREE = 0,
+    STREAM_SLOT_CAPTURING = 1,
+    STREAM_SLOT_READY = 2,      // captured, waiting for the delivery to JS
+    STREAM_SLOT_LENT = 3        // memory of a live ArrayBuffer
+};
+
+// Slots a delivery leaves to the capture thread, frames beyond them are copied instead of lent
+#define STREAM_IDLE_SLOTS 2
+
+struct StreamSlot {
+    ScreenStreamState* stream;
+    ShmSegment* segment = nullptr;
+    StreamSlotState state = STREAM_SLOT_FREE;
+    uint64_t sequence = 0;
+    uint64_t timestamp = 0;     // CLOCK_MONOTONIC nanoseconds at the start of the capture
+    int stride = 0;
+};
+
+// Finalizer hint of a lent ArrayBuffer, the slot may be released and lent again before it runs
+struct StreamLend {
+    StreamSlot* slot;
+    uint64_t sequence;
+};
+
+struct ScreenStreamState {
+    Display* display;           // own connection, used by the capture thread only
+    XRectangle area;
+    uint64_t period;            // nanoseconds between frames
+    std::thread thread;
+    std::atomic<bool> isStopping{false};
+    std::atomic<bool> isDisplayBroken{false};   // set by Xlib when the server connection is lost
+
+    // JS thread only, the stream object, the tsfn and every lent slot hold a reference
+    bool isStopped = false;
+    int references = 0;
+
+    // Slot states and statistics, shared with the capture thread
+    std::mutex mutex;
+    StreamSlot slots[STREAM_MAX_SLOTS];
+    int slotCount = 0;
+    bool isDeliveryPending = false;
+    uint64_t produced = 0;
+    uint64_t dropped = 0;
+    uint64_t captureTotal = 0;
+    uint64_t captureMax = 0;
+
+    Napi::ThreadSafeFunction tsfn;
+    Napi::ObjectReference object;   // the stream object stays alive until stop()
+};
+
+// Streams with a running thread, JS thread only
+static std::vector<ScreenStreamState*> screenStreams;
+
+static uint64_t StreamClock() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static void StreamUnref(ScreenStreamState* stream) {
+    if (--stream->references == 0) {
+        delete stream;
+    }
+}
+
+// ArrayBuffer finalizer of a lent slot, nothing to free if release() gave the slot back already
+static void StreamSlotFinalize(napi_env env, void* data, void* hint) {
+    StreamLend* lend = (StreamLend*)hint;
+    StreamSlot* slot = lend->slot;
+    ScreenStreamState* stream = slot->stream;
+    {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        if (slot->state == STREAM_SLOT_LENT && slot->sequence == lend->sequence) {
+            if (stream->isStopped) {
+                ShmSegmentDestroy(slot->segment);
+                slot->segment = nullptr;
+            } else {
+                slot->state = STREAM_SLOT_FREE;
+            }
+        }
+    }
+    delete lend;
+    StreamUnref(stream);
+}
+
+// JS thread, hand every ready frame to onFrame, oldest first
+static void StreamDeliver(Napi::Env env, Napi::Function onFrame, ScreenStreamState* stream) {
+    StreamSlot* ready[STREAM_MAX_SLOTS];
+    int count = 0;
+    int idle = 0;           // slots not lent to JS
+    {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        stream->isDeliveryPending = false;
+        if (stream->isStopped) {
+            return;
+        }
+        for (int i = 0; i < stream->slotCount; i++) {
+            StreamSlot* slot = &stream->slots[i];
+            if (slot->state != STREAM_SLOT_LENT) {
+                idle++;
+            }
+            if (slot->state != STREAM_SLOT_READY) {
+                continue;
+            }
+            slot->state = STREAM_SLOT_LENT;
+            int j = count++;
+            for (; j > 0 && ready[j - 1]->sequence > slot->sequence; j--) {
+                ready[j] = ready[j - 1];
+            }
+            ready[j] = slot;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        StreamSlot* slot = ready[i];
+        // A throwing onFrame gets no more calls from this delivery
+        if (env.IsExceptionPending()) {
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            slot->state = STREAM_SLOT_FREE;
+            continue;
+        }
+
+        // Frames JS keeps must never starve the capture thread, past the idle slots they are copied
+        size_t length = (size_t)slot->stride * stream->area.height;
+        napi_value data;
+        StreamLend* lend = nullptr;
+        if (idle > STREAM_IDLE_SLOTS) {
+            lend = new StreamLend{slot, slot->sequence};
+            if (napi_create_external_arraybuffer(env, slot->segment->info.shmaddr, length, StreamSlotFinalize, lend, &data) != napi_ok) {
+                delete lend;
+                lend = nullptr;
+            }
+        }
+        if (lend != nullptr) {
+            stream->references++;
+            idle--;
+        } else {
+            // Also for runtimes with the V8 sandbox, they allow no external memory
+            Napi::ArrayBuffer copy = Napi::ArrayBuffer::New(env, length);
+            memcpy(copy.Data(), slot->segment->info.shmaddr, length);
+            data = copy;
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            slot->state = STREAM_SLOT_FREE;
+        }
+
+        Napi::Object frame = Napi::Object::New(env);
+        frame.Set("width", stream->area.width);
+        frame.Set("height", stream->area.height);
+        frame.Set("stride", slot->stride);
+        frame.Set("sequence", (double)slot->sequence);
+        frame.Set("timestamp", slot->timestamp / 1e6);
+        frame.Set("data", Napi::Value(env, data));
+        onFrame.Call({frame});
+    }
+}
+
+static void StreamLoop(ScreenStreamState* stream) {
+    uint64_t deadline = StreamClock();
+    while (!stream->isStopping.load()) {
+        struct timespec spec;
+        spec.tv_sec = (time_t)(deadline / 1000000000ull);
+        spec.tv_nsec = (long)(deadline % 1000000000ull);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &spec, nullptr);
+        if (stream->isStopping.load()) {
+            break;
+        }
+
+        // A free slot, else drop the oldest frame JS has not taken yet
+        StreamSlot* slot = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            for (int i = 0; i < stream->slotCount && (slot == nullptr || slot->state != STREAM_SLOT_FREE); i++) {
+                StreamSlot* candidate = &stream->slots[i];
+                if (candidate->state == STREAM_SLOT_FREE ||
+                    (candidate->state == STREAM_SLOT_READY && (slot == nullptr || candidate->sequence < slot->sequence))) {
+                    slot = candidate;
+                }
+            }
+            // Every slot lent means this frame is dropped instead
+            if (slot == nullptr || slot->state == STREAM_SLOT_READY) {
+                stream->dropped++;
+            }
+            if (slot != nullptr) {
+                slot->state = STREAM_SLOT_CAPTURING;
+            }
+        }
+
+        if (slot != nullptr) {
+            uint64_t start = StreamClock();
+            XImage* image = ShmSegmentCapture(slot->segment, stream->area.x, stream->area.y, stream->area.width, stream->area.height);
+            uint64_t elapsed = StreamClock() - start;
+
+            // The server went away, the stream ends and stats() reports it as failed
+            if (stream->isDisplayBroken.load()) {
+                std::lock_guard<std::mutex> lock(stream->mutex);
+                slot->state = STREAM_SLOT_FREE;
+                break;
+            }
+
+            bool isCall = false;
+            {
+                std::lock_guard<std::mutex> lock(stream->mutex);
+                if (image == nullptr || image->bits_per_pixel != 32) {
+                    slot->state = STREAM_SLOT_FREE;
+                } else {
+                    slot->state = STREAM_SLOT_READY;
+                    slot->sequence = ++stream->produced;
+                    slot->timestamp = start;
+                    slot->stride = image->bytes_per_line;
+                    stream->captureTotal += elapsed;
+                    if (elapsed > stream->captureMax) {
+                        stream->captureMax = elapsed;
+                    }
+                    // One queued delivery takes every ready frame
+                    if (!stream->isDeliveryPending) {
+                        stream->isDeliveryPending = true;
+                        isCall = true;
+                    }
+                }
+            }
+            if (isCall && stream->tsfn.NonBlockingCall(stream, StreamDeliver) != napi_ok) {
+                std::lock_guard<std::mutex> lock(stream->mutex);
+                stream->isDeliveryPending = false;
+            }
+        }
+
+        // Stay on the grid of the first deadline, ticks missed by a slow capture are skipped
+        deadline += stream->period;
+        uint64_t now = StreamClock();
+        if (now > deadline) {
+            deadline += ((now - deadline) / stream->period + 1) * stream->period;
+        }
+    }
+}
+
+// Free the segments of the slots JS does not hold and close the connection
+static void StreamFreeSlots(ScreenStreamState* stream) {
+    for (int i = 0; i < stream->slotCount; i++) {
+        StreamSlot* slot = &stream->slots[i];
+        if (slot->segment == nullptr) {
+            continue;
+        }
+        // Closing the connection detaches every segment
+        slot->segment->display = nullptr;
+        if (slot->state != STREAM_SLOT_LENT) {
+            ShmSegmentDestroy(slot->segment);
+            slot->segment = nullptr;
+        }
+    }
+    XCloseDisplay(stream->display);
+    stream->display = nullptr;
+}
+
+// JS thread, no frame is delivered after this returns
+static void StreamStop(ScreenStreamState* stream) {
+    if (stream->isStopped) {
+        return;
+    }
+    stream->isStopping = true;
+    stream->thread.join();
+    stream->isStopped = true;
+    for (size_t i = 0; i < screenStreams.size(); i++) {
+        if (screenStreams[i] == stream) {
+            screenStreams[i] = screenStreams.back();
+            screenStreams.pop_back();
+            break;
+        }
+    }
+    StreamFreeSlots(stream);
+    stream->tsfn.Release();
+    stream->object.Reset();
+}
+#endif
+
+Napi::Value IScreen::startStream(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected options object").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Napi::Object options = info[0].As<Napi::Object>();
+    Napi::Value onFrame = options.Get("onFrame");
+    if (!onFrame.IsFunction()) {
+        Napi::TypeError::New(env, "Expected onFrame function").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    const char* names[2] = {"fps", "slots"};
+    int values[2] = {30, 3};
+    const int limits[2][2] = {{1, 240}, {2, STREAM_MAX_SLOTS}};
+    for (int i = 0; i < 2; i++) {
+        Napi::Value value = options.Get(names[i]);
+        if (value.IsUndefined()) {
+            continue;
+        }
+        if (!value.IsNumber()) {
+            Napi::TypeError::New(env, std::string("Expected number ") + names[i] + " option").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        values[i] = value.As<Napi::Number>().Int32Value();
+        if (values[i] < limits[i][0] || values[i] > limits[i][1]) {
+            Napi::RangeError::New(env, std::string(names[i]) + " out of range (" + std::to_string(limits[i][0]) + "-" +
+                std::to_string(limits[i][1]) + ")").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+    }
+
+    #if defined(IS_LINUX)
+        // The capture thread gets its own connection, input injection keeps the shared one
+        // It is created first, so the connection is opened with Xlib in thread safe mode
+        ScreenStreamState* stream = new ScreenStreamState();
+        Display* display = XOpenThreadDisplay(&stream->isDisplayBroken);
+        if (display == NULL) {
+            delete stream;
+            Napi::Error::New(env, "Failed to open the X display").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        int x, y, width, height;
+        if (!ScreenRegion(env, options.Get("region"), display, x, y, width, height)) {
+            XCloseDisplay(display);
+            delete stream;
+            return env.Undefined();
+        }
+        if (!XShmQueryExtension(display)) {
+            XCloseDisplay(display);
+            delete stream;
+            Napi::Error::New(env, "Screen streaming needs the MIT-SHM extension").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+
+        // Every frame buffer is allocated and attached up front
+        stream->display = display;
+        stream->area = {(short)x, (short)y, (unsigned short)width, (unsigned short)height};
+        stream->period = 1000000000ull / values[0];
+        stream->slotCount = values[1];
+        for (int i = 0; i < stream->slotCount; i++) {
+            stream->slots[i].stream = stream;
+            stream->slots[i].segment = ShmSegmentCreate(display, (size_t)width * height * 4);
+            if (stream->slots[i].segment == nullptr) {
+                StreamFreeSlots(stream);
+                delete stream;
+                Napi::Error::New(env, "Failed to allocate the frame buffers").ThrowAsJavaScriptException();
+                return env.Undefined();
+            }
+        }
+
+        stream->references = 2;
+        stream->tsfn = Napi::ThreadSafeFunction::New(env, onFrame.As<Napi::Function>(), "ScreenStream", 0, 1, stream,
+            [](Napi::Env env, ScreenStreamState* stream) {
+                StreamUnref(stream);
+            });
+        screenStreams.push_back(stream);
+        stream->thread = std::thread(StreamLoop, stream);
+        Napi::Object object = streamConstructor->New({Napi::External<ScreenStreamState>::New(env, stream)});
+        stream->object = Napi::Persistent(object);
+        return object;
+    #else
+        Napi::Error::New(env, "Screen streaming is not supported on this platform").ThrowAsJavaScriptException();
+        return env.Undefined();
+    #endif
+}
+
+ScreenStream::ScreenStream(const Napi::CallbackInfo& info) : Napi::ObjectWrap<ScreenStream>(info) {
+    #if defined(IS_LINUX)
+        if (info.Length() < 1 || !info[0].IsExternal()) {
+            Napi::TypeError::New(info.Env(), "Use Screen.startStream()").ThrowAsJavaScriptException();
+            return;
+        }
+        this->m_state = info[0].As<Napi::External<ScreenStreamState>>().Data();
+    #endif
+}
+
+ScreenStream::~ScreenStream() {
+    #if defined(IS_LINUX)
+        if (this->m_state != nullptr) {
+            StreamStop(this->m_state);
+            StreamUnref(this->m_state);
+            this->m_state = nullptr;
+        }
+    #endif
+}
+
+void ScreenStream::Stop(const Napi::CallbackInfo& info) {
+    #if defined(IS_LINUX)
+        if (this->m_state != nullptr) {
+            StreamStop(this->m_state);
+        }
+    #endif
+}
+
+void ScreenStream::ReleaseFrame(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected frame object").ThrowAsJavaScriptException();
+        return;
+    }
+
+    #if defined(IS_LINUX)
+        if (this->m_state == nullptr) {
+            return;
+        }
+        ScreenStreamState* stream = this->m_state;
+        Napi::Object frame = info[0].As<Napi::Object>();
+        Napi::Value sequenceValue = frame.Get("sequence");
+        Napi::Value dataValue = frame.Get("data");
+        if (!sequenceValue.IsNumber() || !dataValue.IsArrayBuffer()) {
+            Napi::TypeError::New(env, "Expected a frame of this stream").ThrowAsJavaScriptException();
+            return;
+        }
+        uint64_t sequence = (uint64_t)sequenceValue.As<Napi::Number>().DoubleValue();
+        Napi::ArrayBuffer data = dataValue.As<Napi::ArrayBuffer>();
+
+        // Copied and already released frames have no slot, they are left to the GC
+        StreamSlot* slot = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            for (int i = 0; i < stream->slotCount && slot == nullptr; i++) {
+                StreamSlot* candidate = &stream->slots[i];
+                if (candidate->state == STREAM_SLOT_LENT && candidate->sequence == sequence &&
+                    candidate->segment != nullptr && data.Data() == candidate->segment->info.shmaddr) {
+                    slot = candidate;
+                }
+            }
+        }
+        if (slot == nullptr) {
+            return;
+        }
+
+        // The capture thread may write the slot again, JS must not see it any more
+        // Detaching may run the finalizer right away, so it happens outside the lock
+        if (napi_detach_arraybuffer(env, data) != napi_ok) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        if (slot->state != STREAM_SLOT_LENT || slot->sequence != sequence) {
+            return;
+        }
+        if (stream->isStopped) {
+            ShmSegmentDestroy(slot->segment);
+            slot->segment = nullptr;
+        }
+        slot->state = STREAM_SLOT_FREE;
+    #endif
+}
+
+Napi::Value ScreenStream::Stats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object result = Napi::Object::New(env);
+
+    #if defined(IS_LINUX)
+        if (this->m_state != nullptr) {
+            ScreenStreamState* stream = this->m_state;
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            result.Set("produced", (double)stream->produced);
+            result.Set("dropped", (double)stream->dropped);
+            result.Set("captureTimeUs", stream->produced > 0 ? stream->captureTotal / 1e3 / stream->produced : 0.0);
+            result.Set("captureTimeMaxUs", stream->captureMax / 1e3);
+            result.Set("failed", stream->isDisplayBroken.load());
+        }
+    #endif
+    return result;
+}
+
+Napi::Function ScreenStream::Init(Napi::Env env) {
+    return DefineClass(env, "ScreenStream", {
+        InstanceMethod("stop", &ScreenStream::Stop),
+        InstanceMethod("release", &ScreenStream::ReleaseFrame),
+        InstanceMethod("stats", &ScreenStream::Stats)
+    });
+}
+
 
 Napi::Object IScreen::Init(Napi::Env env, Napi::Object exports) {
     Napi::Object obj = Napi::Object::New(env);
     obj.Set(Napi::String::New(env, "list"), Napi::Function::New(env, IScreen::list));
+    obj.Set(Napi::String::New(env, "capture"), Napi::Function::New(env, IScreen::capture));
+    obj.Set(Napi::String::New(env, "convert"), Napi::Function::New(env, IScreen::convert));
+    obj.Set(Napi::String::New(env, "capturePNG"), Napi::Function::New(env, IScreen::capturePNG));
+    obj.Set(Napi::String::New(env, "encodePNG"), Napi::Function::New(env, IScreen::encodePNG));
+    obj.Set(Napi::String::New(env, "createSession"), Napi::Function::New(env, IScreen::createSession));
+    obj.Set(Napi::String::New(env, "startStream"), Napi::Function::New(env, IScreen::startStream));
+
+    // The gamepad constructor holds the instance data slot
+    sessionConstructor = new Napi::FunctionReference();
+    *sessionConstructor = Napi::Persistent(ScreenSession::Init(env));
+    streamConstructor = new Napi::FunctionReference();
+    *streamConstructor = Napi::Persistent(ScreenStream::Init(env));
+
+    #if defined(IS_LINUX)
+        // Instruction set of the convert() kernels, EASY_CONTROL_SIMD=scalar|sse2|avx2 caps it
+        obj.Set(Napi::String::New(env, "simd"), Napi::String::New(env, PixelsKernel()));
+
+        // Stop the capture and PNG helper threads and detach the idle segments, the ones still
+        // lent to JS are removed when collected
+        napi_add_env_cleanup_hook(env, [](void* arg) {
+            while (!screenStreams.empty()) {
+                StreamStop(screenStreams.back());
+            }
+            PngEncodeStop();
+            shmPoolClosed = true;
+            while (!shmPool.empty()) {
+                ShmSegmentDestroy(shmPool.back());
+                shmPool.pop_back();
+            }
+        }, nullptr);
+    #endif
     return obj;
 }
@@ -3,11 +3,107 @@
 #define SCREEN_H
 
 #include <napi.h>
+#include <vector>
+
+#include "display.h"
+
+#if defined(IS_LINUX)
+    // Capture thread, frame slots and statistics of one startStream()
+    struct ScreenStreamState;
+
+    // MIT-SHM segment lent by the capture pool
+    struct ShmSegment;
+#endif
 
 class IScreen {
     public:
         static Napi::Object Init(Napi::Env env, Napi::Object exports);
         static Napi::Array list(const Napi::CallbackInfo& info);
+        static Napi::Value capture(const Napi::CallbackInfo& info);
+        static Napi::Value convert(const Napi::CallbackInfo& info);
+        static Napi::Value capturePNG(const Napi::CallbackInfo& info);
+        static Napi::Value encodePNG(const Napi::CallbackInfo& info);
+        static Napi::Value createSession(const Napi::CallbackInfo& info);
+        static Napi::Value startStream(const Napi::CallbackInfo& info);
+};
+
+// Screen.capturePNG() and encodePNG(), the stripes are deflated in parallel off the JS thread
+class EncodePNG : public Napi::AsyncWorker {
+    public:
+        EncodePNG(const Napi::Env& env, int width, int height, int level, int threads);
+        ~EncodePNG();
+        Napi::Promise GetPromise();
+
+        // Packed BGRX rows for the worker to fill, encodePNG() copies the frame in
+        uint8_t* Allocate();
+        #if defined(IS_LINUX)
+            // Take over a captured image, the segment goes back to the pool when the worker is done
+            void Adopt(ShmSegment* segment, XImage* image);
+        #endif
+
+    protected:
+        void Execute();
+        void OnOK();
+        void OnError(const Napi::Error& e);
+
+    private:
+        Napi::Promise::Deferred m_deferred;
+        int m_width;
+        int m_height;
+        int m_level;
+        int m_threads;
+        const uint8_t* m_pixels = nullptr;
+        int m_stride = 0;
+        std::vector<uint8_t> m_copy;
+        std::vector<uint8_t> m_png;
+        #if defined(IS_LINUX)
+            ShmSegment* m_segment = nullptr;
+            XImage* m_image = nullptr;  // owned without a segment
+        #endif
+};
+
+// Screen.createSession(), captures only the parts of a region that changed since the last next()
+class ScreenSession : public Napi::ObjectWrap<ScreenSession> {
+    public:
+        static Napi::Function Init(Napi::Env env);
+        ScreenSession(const Napi::CallbackInfo& info);
+        ~ScreenSession();
+        Napi::Value Next(const Napi::CallbackInfo& info);
+        void Close(const Napi::CallbackInfo& info);
+
+    private:
+        // Free the server side objects, the session is closed afterwards
+        void Release();
+
+        int m_maxRects = 16;        // more damaged rects than this are merged into their bounding box
+        bool m_isFirst = true;      // the first next() returns the whole region
+        #if defined(IS_LINUX)
+            Display* m_display = nullptr;
+            int m_eventBase = 0;
+            XRectangle m_area;          // captured region of the desktop
+            unsigned long m_damage = 0; // Damage of the root window
+            unsigned long m_region = 0; // XserverRegion the damage is moved into
+            unsigned long m_bounds = 0; // XserverRegion of m_area
+            std::vector<XRectangle> m_rects;
+            std::vector<uint32_t> m_offsets;
+            std::vector<uint32_t> m_strides;
+        #endif
+};
+
+// Screen.startStream(), a capture thread delivering frames at a fixed rate
+class ScreenStream : public Napi::ObjectWrap<ScreenStream> {
+    public:
+        static Napi::Function Init(Napi::Env env);
+        ScreenStream(const Napi::CallbackInfo& info);
+        ~ScreenStream();
+        void Stop(const Napi::CallbackInfo& info);
+        void ReleaseFrame(const Napi::CallbackInfo& info);
+        Napi::Value Stats(const Napi::CallbackInfo& info);
+
+    private:
+        #if defined(IS_LINUX)
+            ScreenStreamState* m_state = nullptr;
+        #endif
 };
 
-#endif
\ No newline at end of file
+#endif
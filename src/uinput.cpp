@@ -0,0 +1,116 @@
+#include "uinput.h"
+
+#if defined(IS_LINUX)
+    #include <stdint.h>
+    #include <string.h>
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <time.h>
+    #include <poll.h>
+    #include <dirent.h>
+    #include <stdio.h>
+    #include <sys/ioctl.h>
+    #include <sys/inotify.h>
+
+    int UinputOpen() {
+        // Try multiple possible paths for uinput, read access is for the force feedback requests
+        int fd = open("/dev/uinput", O_RDWR | O_NONBLOCK);
+        if (fd < 0) {
+            // Try alternative path
+            fd = open("/dev/input/uinput", O_RDWR | O_NONBLOCK);
+            if (fd < 0) {
+                // Try without O_NONBLOCK
+                fd = open("/dev/uinput", O_RDWR);
+                if (fd < 0) {
+                    fd = open("/dev/input/uinput", O_RDWR);
+                }
+            }
+        }
+        return fd;
+    }
+
+    bool UinputWriteFrame(int fd, const struct input_event* events, size_t count) {
+        if (count > UINPUT_MAX_FRAME) {
+            return false;
+        }
+
+        struct input_event frame[UINPUT_MAX_FRAME + 1];
+        memcpy(frame, events, count * sizeof(struct input_event));
+
+        memset(&frame[count], 0, sizeof(struct input_event));
+        frame[count].type = EV_SYN;
+        frame[count].code = SYN_REPORT;
+        frame[count].value = 0;
+
+        return write(fd, frame, (count + 1) * sizeof(struct input_event)) >= 0;
+    }
+
+    static int64_t MonotonicMs() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+    }
+
+    bool UinputWaitForNode(int fd, int timeoutMs) {
+        char sysname[64];
+        if (ioctl(fd, UI_GET_SYSNAME(sizeof(sysname)), sysname) < 0) {
+            // Kernels before 3.15 cannot name the device, fall back to a fixed delay
+            usleep(100000);
+            return true;
+        }
+
+        // The evdev handler is attached during UI_DEV_CREATE, so sysfs already knows the node name
+        char path[128];
+        snprintf(path, sizeof(path), "/sys/class/input/%s", sysname);
+        char node[128] = "";
+        DIR* dir = opendir(path);
+        if (dir != nullptr) {
+            struct dirent* entry;
+            while ((entry = readdir(dir)) != nullptr) {
+                if (strncmp(entry->d_name, "event", 5) == 0) {
+                    snprintf(node, sizeof(node), "/dev/input/%s", entry->d_name);
+                    break;
+                }
+            }
+            closedir(dir);
+        }
+        if (node[0] == '\0') {
+            usleep(100000);
+            return true;
+        }
+
+        // devtmpfs creates the node asynchronously, watch the directory from before the first check
+        int watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (watchFd >= 0 && inotify_add_watch(watchFd, "/dev/input", IN_CREATE | IN_MOVED_TO) < 0) {
+            close(watchFd);
+            watchFd = -1;
+        }
+
+        bool isFound = false;
+        int64_t deadline = MonotonicMs() + timeoutMs;
+        while (true) {
+            if (access(node, F_OK) == 0) {
+                isFound = true;
+                break;
+            }
+            int64_t remaining = deadline - MonotonicMs();
+            if (remaining <= 0) {
+                break;
+            }
+            if (watchFd < 0) {
+                usleep(remaining < 5 ? remaining * 1000 : 5000);
+                continue;
+            }
+            struct pollfd pfd = {watchFd, POLLIN, 0};
+            if (poll(&pfd, 1, (int)remaining) > 0) {
+                char events[1024];
+                while (read(watchFd, events, sizeof(events)) > 0) {}
+            }
+        }
+
+        if (watchFd >= 0) {
+            close(watchFd);
+        }
+        return isFound;
+    }
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+#ifndef UINPUT_H
+#define UINPUT_H
+
+#if defined(IS_LINUX)
+    #include <stddef.h>
+    #include <linux/uinput.h>
+
+    // Maximum events in one frame, without the closing SYN_REPORT
+    #define UINPUT_MAX_FRAME 64
+
+    // Open the uinput control device, returns -1 on failure
+    int UinputOpen();
+
+    // Write the events and one closing SYN_REPORT with a single write() call
+    bool UinputWriteFrame(int fd, const struct input_event* events, size_t count);
+
+    // Block until the /dev/input/event* node of a created device exists, false on timeout
+    // When the node name cannot be found out it waits a fixed delay and returns true
+    bool UinputWaitForNode(int fd, int timeoutMs);
+#endif
+
+#endif